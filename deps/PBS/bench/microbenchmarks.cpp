@@ -0,0 +1,354 @@
+// Microbenchmarks of the PBS low-level kernels.
+// One instance is solved once with PBS, then every benchmark replays a single kernel on the solution:
+// the agent with the longest path is replanned against all the other paths (a feasible priority order,
+// since the solution is conflict-free).
+//
+//   ./pbs_microbenchmarks --map=env/grid.map [--assignment=<file>] [--agents=30 --waypoints=4 --seed=0]
+//                         [--time_limit=60] [google benchmark flags]
+//
+// The assignment file has the Instance::loadAgents format: the number of agents on the first line, then one
+// "n,row_1,col_1,...,row_n,col_n" line of waypoints per agent. Without it the waypoints are sampled from the
+// endpoints ('e') of the map.
+//
+// The global operator new below counts the heap in use, so that BM_findOptimalPath also reports the peak memory
+// of a call.
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <benchmark/benchmark.h>
+#include <boost/tokenizer.hpp>
+#include "PBS.h"
+#include "ReservationTable.h"
+
+namespace
+{
+	std::atomic<int64_t> heap_in_use{0};
+	std::atomic<int64_t> heap_peak{0};
+	constexpr size_t heap_header = alignof(std::max_align_t); // keeps the size of the block in front of it
+}
+
+void* operator new(size_t size)
+{
+	auto block = static_cast<char*>(std::malloc(size + heap_header));
+	if (block == nullptr)
+		throw std::bad_alloc();
+	*reinterpret_cast<size_t*>(block) = size;
+	int64_t in_use = heap_in_use.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+	int64_t peak = heap_peak.load(std::memory_order_relaxed);
+	while (in_use > peak && !heap_peak.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+	return block + heap_header;
+}
+void operator delete(void* p) noexcept
+{
+	if (p == nullptr)
+		return;
+	auto block = static_cast<char*>(p) - heap_header;
+	heap_in_use.fetch_sub((int64_t)*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+	std::free(block);
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try { return operator new(size); }
+	catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+
+class PBSKernels
+{
+public:
+	static const vector<Path*>& getPaths(const PBS& pbs) { return pbs.paths; }
+	static SingleAgentSolver& getSearchEngine(const PBS& pbs, int agent) { return *pbs.search_engines[agent]; }
+	static bool hasConflicts(const PBS& pbs, int a1, int a2) { return pbs.hasConflicts(a1, a2); }
+	static int getNumOfAgents(const PBS& pbs) { return pbs.num_of_agents; }
+};
+
+namespace
+{
+	struct Workload
+	{
+		std::unique_ptr<Instance> instance;
+		std::unique_ptr<PBS> pbs;
+		int probe = 0; // agent replanned by the low-level benchmarks
+		set<int> higher_agents; // every other agent
+		int64_t higher_steps = 0; // timesteps of the higher paths
+	} workload;
+
+	bool loadMap(const string& fname, vector<bool>& map, vector<int>& endpoints, int& rows, int& cols)
+	{
+		std::ifstream file(fname);
+		string line;
+		if (!file.is_open() || !getline(file, line))
+			return false;
+		boost::char_separator<char> sep(",");
+		boost::tokenizer< boost::char_separator<char> > tok(line, sep);
+		auto beg = tok.begin();
+		rows = atoi((*beg).c_str());
+		++beg;
+		cols = atoi((*beg).c_str());
+
+		map.assign(rows * cols, false);
+		for (int i = 0; i < rows && getline(file, line); i++)
+		{
+			for (int j = 0; j < cols && j < (int)line.size(); j++)
+			{
+				map[i * cols + j] = line[j] == '@';
+				if (line[j] == 'e')
+					endpoints.push_back(i * cols + j);
+			}
+		}
+		return true;
+	}
+
+	bool loadAssignment(const string& fname, int cols, vector<vector<int>>& agents)
+	{
+		std::ifstream file(fname);
+		string line;
+		if (!file.is_open() || !getline(file, line))
+			return false;
+		agents.resize(atoi(line.c_str()));
+		boost::char_separator<char> sep(",");
+		for (auto& locs : agents)
+		{
+			if (!getline(file, line))
+				return false;
+			boost::tokenizer< boost::char_separator<char> > tok(line, sep);
+			auto beg = tok.begin();
+			locs.resize(atoi((*beg).c_str()));
+			for (auto& loc : locs)
+			{
+				int row = atoi((*++beg).c_str());
+				int col = atoi((*++beg).c_str());
+				loc = row * cols + col;
+			}
+		}
+		return true;
+	}
+
+	// distinct starts and final goals, the intermediate waypoints are drawn with replacement
+	vector<vector<int>> sampleAssignment(vector<int> endpoints, int num_of_agents, int waypoints, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::shuffle(endpoints.begin(), endpoints.end(), rng);
+		std::uniform_int_distribution<size_t> pick(0, endpoints.size() - 1);
+		vector<vector<int>> agents(num_of_agents);
+		for (int i = 0; i < num_of_agents; i++)
+		{
+			agents[i].push_back(endpoints[i]);
+			for (int w = 1; w < waypoints - 1; w++)
+				agents[i].push_back(endpoints[pick(rng)]);
+			agents[i].push_back(endpoints[num_of_agents + i]);
+		}
+		return agents;
+	}
+
+	ConstraintTable buildConstraintTable()
+	{
+		const auto& paths = PBSKernels::getPaths(*workload.pbs);
+		ConstraintTable constraint_table(workload.instance->num_of_cols, workload.instance->map_size);
+		for (int a : workload.higher_agents)
+			constraint_table.insert2CT(*paths[a]);
+		constraint_table.insert2CAT(workload.probe, paths);
+		return constraint_table;
+	}
+
+	// the queries SIPP makes when it expands the probe path, returns the number of intervals
+	size_t querySafeIntervals(ReservationTable& reservation_table, const Path& path)
+	{
+		size_t num_of_intervals = 0;
+		for (int t = 0; t + 1 < (int)path.size(); t++)
+		{
+			int loc = path[t].location;
+			Interval interval;
+			if (!reservation_table.find_safe_interval(interval, loc, t))
+				continue;
+			for (int next : workload.instance->getNeighbors(loc))
+				num_of_intervals += reservation_table.get_safe_intervals(loc, next, t + 1, get<1>(interval) + 1).size();
+		}
+		return num_of_intervals;
+	}
+}
+
+static void BM_insert2CT(benchmark::State& state)
+{
+	const auto& paths = PBSKernels::getPaths(*workload.pbs);
+	for (auto _ : state)
+	{
+		ConstraintTable constraint_table(workload.instance->num_of_cols, workload.instance->map_size);
+		for (int a : workload.higher_agents)
+			constraint_table.insert2CT(*paths[a]);
+		benchmark::DoNotOptimize(constraint_table.getMaxTimestep());
+	}
+	state.SetItemsProcessed(state.iterations() * workload.higher_steps);
+}
+BENCHMARK(BM_insert2CT);
+
+static void BM_insert2CAT(benchmark::State& state)
+{
+	const auto& paths = PBSKernels::getPaths(*workload.pbs);
+	for (auto _ : state)
+	{
+		ConstraintTable constraint_table(workload.instance->num_of_cols, workload.instance->map_size);
+		constraint_table.insert2CAT(workload.probe, paths);
+		benchmark::DoNotOptimize(constraint_table.getFutureNumOfCollisions(paths[workload.probe]->back().location, 0));
+	}
+	state.SetItemsProcessed(state.iterations() * workload.higher_steps);
+}
+BENCHMARK(BM_insert2CAT);
+
+// warm = 0 builds the safe interval table lazily in every iteration, as a fresh SIPP search does;
+// warm = 1 only measures the queries on an already built table
+static void BM_get_safe_intervals(benchmark::State& state)
+{
+	const auto constraint_table = buildConstraintTable();
+	const auto& path = *PBSKernels::getPaths(*workload.pbs)[workload.probe];
+	ReservationTable warm_table(constraint_table, path.back().location);
+	size_t num_of_intervals = querySafeIntervals(warm_table, path);
+
+	for (auto _ : state)
+	{
+		if (state.range(0) == 0)
+		{
+			ReservationTable reservation_table(constraint_table, path.back().location);
+			benchmark::DoNotOptimize(querySafeIntervals(reservation_table, path));
+		}
+		else
+		{
+			benchmark::DoNotOptimize(querySafeIntervals(warm_table, path));
+		}
+	}
+	state.counters["intervals"] = (double)num_of_intervals;
+}
+BENCHMARK(BM_get_safe_intervals)->ArgName("warm")->Arg(0)->Arg(1);
+
+static void BM_findOptimalPath(benchmark::State& state)
+{
+	const auto& paths = PBSKernels::getPaths(*workload.pbs);
+	auto& search_engine = PBSKernels::getSearchEngine(*workload.pbs, workload.probe);
+	uint64_t num_expanded = 0;
+	int64_t peak_bytes = 0;
+	for (auto _ : state)
+	{
+		int64_t in_use = heap_in_use.load(std::memory_order_relaxed);
+		heap_peak.store(in_use, std::memory_order_relaxed);
+		auto path = search_engine.findOptimalPath(workload.higher_agents, paths, workload.probe);
+		benchmark::DoNotOptimize(path.data());
+		num_expanded = search_engine.num_expanded;
+		peak_bytes = heap_peak.load(std::memory_order_relaxed) - in_use;
+	}
+	state.counters["ll_expanded"] = (double)num_expanded;
+	state.counters["waypoints"] = (double)search_engine.locs.size();
+	state.counters["peak_bytes"] = benchmark::Counter((double)peak_bytes, benchmark::Counter::kDefaults,
+	                                                  benchmark::Counter::OneK::kIs1024);
+}
+BENCHMARK(BM_findOptimalPath)->Unit(benchmark::kMicrosecond);
+
+static void BM_hasConflicts(benchmark::State& state)
+{
+	const int num_of_agents = PBSKernels::getNumOfAgents(*workload.pbs);
+	for (auto _ : state)
+	{
+		int num_of_conflicts = 0;
+		for (int a1 = 0; a1 < num_of_agents; a1++)
+			for (int a2 = a1 + 1; a2 < num_of_agents; a2++)
+				num_of_conflicts += PBSKernels::hasConflicts(*workload.pbs, a1, a2);
+		benchmark::DoNotOptimize(num_of_conflicts);
+	}
+	state.SetItemsProcessed(state.iterations() * num_of_agents * (num_of_agents - 1) / 2);
+}
+BENCHMARK(BM_hasConflicts);
+
+int main(int argc, char** argv)
+{
+	string map_fname = "env/grid.map", assignment_fname;
+	int num_of_agents = 30, waypoints = 4;
+	unsigned seed = 0;
+	double time_limit = 60;
+
+	// our flags are removed, the rest is left to google benchmark
+	int benchmark_argc = 0;
+	for (int i = 0; i < argc; i++)
+	{
+		string arg = argv[i];
+		auto value = arg.substr(arg.find('=') + 1);
+		if (arg.rfind("--map=", 0) == 0)
+			map_fname = value;
+		else if (arg.rfind("--assignment=", 0) == 0)
+			assignment_fname = value;
+		else if (arg.rfind("--agents=", 0) == 0)
+			num_of_agents = std::stoi(value);
+		else if (arg.rfind("--waypoints=", 0) == 0)
+			waypoints = max(2, std::stoi(value));
+		else if (arg.rfind("--seed=", 0) == 0)
+			seed = std::stoul(value);
+		else if (arg.rfind("--time_limit=", 0) == 0)
+			time_limit = std::stod(value);
+		else
+			argv[benchmark_argc++] = argv[i];
+	}
+
+	vector<bool> map;
+	vector<int> endpoints;
+	int rows, cols;
+	if (!loadMap(map_fname, map, endpoints, rows, cols))
+	{
+		cerr << "Cannot read the map " << map_fname << endl;
+		return 1;
+	}
+
+	vector<vector<int>> agents;
+	if (!assignment_fname.empty())
+	{
+		if (!loadAssignment(assignment_fname, cols, agents))
+		{
+			cerr << "Cannot read the assignment " << assignment_fname << endl;
+			return 1;
+		}
+	}
+	else
+	{
+		if ((int)endpoints.size() < 2 * num_of_agents)
+		{
+			cerr << "The map has " << endpoints.size() << " endpoints, not enough for " << num_of_agents << " agents" << endl;
+			return 1;
+		}
+		agents = sampleAssignment(endpoints, num_of_agents, waypoints, seed);
+	}
+
+	workload.instance = std::make_unique<Instance>(map, agents, rows, cols);
+	workload.pbs = std::make_unique<PBS>(*workload.instance, true, 0, seed);
+	workload.pbs->solve(time_limit);
+	if (!workload.pbs->solution_found)
+	{
+		cerr << "PBS found no solution within " << time_limit << " seconds" << endl;
+		return 1;
+	}
+
+	const auto& paths = PBSKernels::getPaths(*workload.pbs);
+	for (int a = 0; a < (int)paths.size(); a++)
+	{
+		if (paths[a]->size() > paths[workload.probe]->size())
+			workload.probe = a;
+	}
+	for (int a = 0; a < (int)paths.size(); a++)
+	{
+		if (a == workload.probe)
+			continue;
+		workload.higher_agents.insert(a);
+		workload.higher_steps += (int64_t)paths[a]->size();
+	}
+
+	benchmark::Initialize(&benchmark_argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(benchmark_argc, argv))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include "common.h"
 
-enum conflict_selection {RANDOM, EARLIEST, CONFLICTS, MCONSTRAINTS, FCONSTRAINTS, WIDTH, SINGLETONS};
+enum conflict_selection {RANDOM, EARLIEST, CONFLICTS, MCONSTRAINTS, FCONSTRAINTS, WIDTH, SINGLETONS, NEWEST};
+
+string toString(conflict_selection rule);
+conflict_selection conflictSelectionFromString(const string& name); // throws std::invalid_argument for unknown names
 
 struct Constraint
 {
@@ -0,0 +1,22 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include "common.h"
+
+class Instance;
+
+// BFS distances to goal locations, computed on demand and shared by every agent (and every instance)
+// planned on the same grid. Lookups are thread-safe and the returned tables stay valid as long as the
+// HeuristicTable is alive.
+class HeuristicTable
+{
+public:
+	const vector<int>& get(const Instance& instance, int goal_location);
+	size_t size() const;
+
+private:
+	mutable std::mutex mutex;
+	unordered_map<int, std::unique_ptr<vector<int> > > tables;
+
+	static vector<int> compute(const Instance& instance, int goal_location);
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include"common.h"
+#include "HeuristicTable.h"
 
 // Currently only works for undirected unweighted 4-nighbor grids
 class Instance 
@@ -8,12 +9,14 @@ public:
 	int num_of_cols;
 	int num_of_rows;
 	int map_size;
+	shared_ptr<HeuristicTable> heuristics; // may be shared by instances on the same grid
 
 	// enum valid_moves_t { NORTH, EAST, SOUTH, WEST, WAIT_MOVE, MOVE_COUNT };  // MOVE_COUNT is the enum's size
 
 	Instance(){}
 
-    Instance(vector<bool> map, vector<vector<int>> agents, int nRows, int nCols);
+    Instance(vector<bool> map, vector<vector<int>> agents, int nRows, int nCols,
+             shared_ptr<HeuristicTable> heuristics = nullptr);
 
 
 		inline bool isObstacle(int loc) const { return my_map[loc]; }
@@ -1,7 +1,15 @@
 #pragma once
+#include <functional>
 #include "PBSNode.h"
 #include "SingleAgentSolver.h"
 
+// anytime mode: keep searching after the first solution and prune nodes that cannot beat the incumbent
+enum anytime_objective { ANYTIME_OFF, ANYTIME_MAKESPAN, ANYTIME_SOC };
+anytime_objective anytimeFromString(const string& name); // "off", "makespan" or "soc", throws std::invalid_argument for unknown names
+
+// called on every improved solution with the runtime at which it was found
+typedef std::function<void(double runtime, size_t makespan, int sum_of_costs, const vector<Path*>& paths)> solution_callback;
+
 class PBS
 {
 public:
@@ -13,12 +21,17 @@ public:
 	double runtime_build_CAT = 0; // runtime of building conflict avoidance table
 	double runtime_path_finding = 0; // runtime of finding paths for single agents
 	double runtime_detect_conflicts = 0;
+	double runtime_choose_conflict = 0; // runtime of applying the conflict selection rule
 	double runtime_preprocessing = 0; // runtime of building heuristic table for the low level
 
 	uint64_t num_HL_expanded = 0;
 	uint64_t num_HL_generated = 0;
 	uint64_t num_LL_expanded = 0;
 	uint64_t num_LL_generated = 0;
+	uint64_t num_LDS_restarts = 0;
+	uint64_t num_HL_pruned = 0; // nodes discarded by the incumbent in anytime mode
+	uint64_t num_solutions = 0;
+	uint64_t num_window_replanned = 0; // agents replanned by the root of the last solveWindow
 
 	PBSNode* dummy_start = nullptr;
     PBSNode* goal_node = nullptr;
@@ -31,13 +44,29 @@ public:
 	/////////////////////////////////////////////////////////////////////////////////////////
 	// set params
 	void setConflictSelectionRule(conflict_selection c) { conflict_seletion_rule = c;}
+	void setHighLevelSearch(high_level_search s) { search_strategy = s; open_heap = heap_open_t(PBSNode::compare_node{s}); }
 	void setNodeLimit(int n) { node_limit = n; }
+	void setAnytime(anytime_objective o, solution_callback callback = nullptr)
+	{
+		anytime = o;
+		on_solution = std::move(callback);
+	}
 
 	////////////////////////////////////////////////////////////////////////////////////////////
 	// Runs the algorithm until the problem is solved or time is exhausted 
 	bool solve(double time_limit);
 
-	PBS(const Instance& instance, bool sipp, int screen);
+	////////////////////////////////////////////////////////////////////////////////////////////
+	// Lifelong planning with a rolling horizon (RHCR): only the conflicts in the first w timesteps are resolved
+	void setWindow(int w);
+	// Plans the next window once the agents have executed the first `executed` timesteps of the current solution
+	// (ignored without one, e.g. by the first call, which starts from the instance); goals[a] are the goals left to
+	// agent a.
+	// Agents whose goals did not change keep the rest of their path and their priorities unless it now collides
+	// with a higher agent, the others are replanned. Falls back to a root planned from scratch if that fails.
+	bool solveWindow(const vector<vector<int>>& goals, int executed, double time_limit);
+
+	PBS(const Instance& instance, bool sipp, int screen, unsigned seed = 0); // seed drives the low-level tie-breaking
 	void clearSearchEngines();
 	~PBS();
 
@@ -46,13 +75,24 @@ public:
 	void printResults(const string &fileName, const string &instanceName) const;
 	void saveCT(const string &fileName) const; // write the CT to a file
     void savePaths(const string &fileName) const; // write the paths to a file
+    void saveRunLengthPaths(const string &fileName, bool binary) const; // compact dump, see readRunLengthPaths
 	void clear(); // used for rapid random  restart
 
     void printPaths() const;
+    void writePaths(std::ostream& os) const; // "agent\tcost\tpath" format used by savePaths and printPaths
 private:
-	conflict_selection conflict_seletion_rule;
-
-    stack<PBSNode*> open_list;
+	friend class PBSKernels; // bench/microbenchmarks.cpp times the private kernels on a solved instance
+
+	conflict_selection conflict_seletion_rule = NEWEST;
+	high_level_search search_strategy = HL_DFS;
+	anytime_objective anytime = ANYTIME_OFF;
+	solution_callback on_solution;
+
+    typedef pairing_heap< PBSNode*, compare<PBSNode::compare_node> > heap_open_t;
+    stack<PBSNode*> open_list; // used by DFS and LDS
+    heap_open_t open_heap; // used by the best-first strategies
+    list<PBSNode*> deferred_list; // LDS nodes beyond the current discrepancy limit
+    int discrepancy_limit = 0;
 	list<PBSNode*> allNodes_table;
 
 
@@ -65,10 +105,16 @@ private:
 	
 	double time_limit;
 	int node_limit = MAX_NODES;
+	int window = MAX_TIMESTEP; // conflicts from this timestep on are ignored
+	vector<vector<bool>> base_priorities; // priorities kept from the previous window, every node starts from them
+
+	steady_clock::time_point start;
 
-	clock_t start;
+	std::mt19937 rng; // used by the RANDOM conflict selection rule
 
 	int num_of_agents;
+	int num_of_rows; // kept so that paths can be written after clearSearchEngines
+	int num_of_cols;
 
 
 	vector<Path*> paths;
@@ -78,7 +124,9 @@ private:
 
 	bool hasConflicts(int a1, int a2) const;
     bool hasConflicts(int a1, const set<int>& agents) const;
-	shared_ptr<Conflict> chooseConflict(const PBSNode &node) const;
+    int getEarliestConflictTimestep(int a1, int a2) const; // -1 if the paths are conflict-free
+	shared_ptr<Conflict> chooseConflict(const PBSNode &node);
+    int getNumOfPriorities(int agent) const; // number of agents with a priority relation to the given agent
     int getSumOfCosts() const;
 	inline void releaseNodes();
 
@@ -92,6 +140,8 @@ private:
 
 	vector<int> shuffleAgents() const;  //generate random permuattion of agent indices
 	bool terminate(PBSNode* curr); // check the stop condition and return true if it meets
+	int getObjective(const PBSNode& node) const; // value minimized by the anytime mode
+	bool isDominatedByIncumbent(const PBSNode& node) const;
 
     void getHigherPriorityAgents(const list<int>::reverse_iterator & p1, set<int>& agents);
     void getLowerPriorityAgents(const list<int>::iterator & p1, set<int>& agents);
@@ -101,9 +151,14 @@ private:
 	void pushNode(PBSNode* node);
     void pushNodes(PBSNode* n1, PBSNode* n2);
 	PBSNode* selectNode();
+	bool openListEmpty(); // for LDS, an empty stack starts the next iteration with a larger discrepancy limit
+	void clearOpenList();
 
 		 // high level search
 	bool generateRoot();
+	bool generateWarmRoot(vector<Path>& kept_paths, const vector<bool>& changed);
+	bool replanInRoot(int a, const set<int>& higher_agents); // false, and the path is kept, if a has no path below them
+	bool runHighLevelSearch(); // the search loop shared by solve and solveWindow
     bool findPathForSingleAgent(PBSNode& node, const set<int>& higher_agents, int a, Path& new_path);
 	void classifyConflicts(PBSNode &parent);
 	void update(PBSNode* node);
@@ -4,6 +4,12 @@
 
 enum node_selection { NODE_RANDOM, NODE_H, NODE_DEPTH, NODE_CONFLICTS, NODE_CONFLICTPAIRS, NODE_MVC };
 
+// high-level frontier: depth-first, best-first on sum of costs or on makespan, limited discrepancy search
+enum high_level_search { HL_DFS, HL_BEST_COST, HL_BEST_MAKESPAN, HL_LDS };
+
+string toString(high_level_search strategy);
+high_level_search highLevelSearchFromString(const string& name); // throws std::invalid_argument for unknown names
+
 
 class PBSNode
 {
@@ -14,6 +20,7 @@ public:
 
 	size_t depth = 0; // depath of this CT node
 	size_t makespan = 0; // makespan over all paths
+	int discrepancies = 0; // number of times the more expensive child was taken on the way from the root (LDS)
 
 	uint64_t time_expanded = 0;
 	uint64_t time_generated = 0;
@@ -28,7 +35,8 @@ public:
 
     PBSNode() = default;
     PBSNode(PBSNode& parent) : cost(parent.cost), depth(parent.depth+1),
-                               makespan(parent.makespan), conflicts(parent.conflicts), parent(&parent){ }
+                               makespan(parent.makespan), discrepancies(parent.discrepancies),
+                               conflicts(parent.conflicts), parent(&parent){ }
 	void clear();
 	void printConstraints(int id) const;
     inline int getNumNewPaths() const { return (int) paths.size(); }
@@ -40,6 +48,25 @@ public:
             rst.push_back(path.first);
         return rst;
     }
+
+	// used by the best-first frontier
+	struct compare_node
+	{
+		high_level_search strategy = HL_BEST_COST;
+		// returns true if n1 > n2 (note -- this gives us *min*-heap).
+		bool operator()(const PBSNode* n1, const PBSNode* n2) const
+		{
+			if (strategy == HL_BEST_MAKESPAN && n1->makespan != n2->makespan)
+				return n1->makespan > n2->makespan;
+			if (n1->cost != n2->cost)
+				return n1->cost > n2->cost;
+			if (n1->makespan != n2->makespan)
+				return n1->makespan > n2->makespan;
+			if (n1->conflicts.size() != n2->conflicts.size())
+				return n1->conflicts.size() > n2->conflicts.size();  // break ties towards fewer conflicts
+			return n1->time_generated < n2->time_generated;  // then towards newer (deeper) nodes
+		}
+	};
 };
 
 std::ostream& operator<<(std::ostream& os, const PBSNode& node);
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+// Process-wide registry of wall-clock phase timers and event counters.
+// Timers and counters are registered once by name and then updated with relaxed atomics,
+// so they can be shared by several threads; when the registry is disabled a ScopedTimer
+// does not even read the clock.
+class Profiler
+{
+public:
+	struct Timer
+	{
+		std::atomic<uint64_t> count{0};
+		std::atomic<uint64_t> total_ns{0};
+		std::atomic<uint64_t> max_ns{0};
+		void add(uint64_t ns);
+	};
+	struct Counter
+	{
+		std::atomic<uint64_t> value{0};
+		void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+	};
+
+	static Profiler& instance();
+
+	void setEnabled(bool e) { enabled.store(e, std::memory_order_relaxed); }
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// returned references stay valid for the lifetime of the program
+	Timer& getTimer(const std::string& name);
+	Counter& getCounter(const std::string& name);
+
+	void reset(); // zero all timers and counters, e.g. between the instances of a batch
+	std::string toJson() const; // {"timers":{name:{"count":..,"total":..,"max":..}},"counters":{name:..}}, seconds
+
+private:
+	Profiler() = default;
+
+	std::atomic<bool> enabled{false};
+	mutable std::mutex mutex; // guards registration only
+	std::deque<std::pair<std::string, Timer> > timers; // deque: stable addresses
+	std::deque<std::pair<std::string, Counter> > counters;
+	std::unordered_map<std::string, Timer*> timer_index;
+	std::unordered_map<std::string, Counter*> counter_index;
+};
+
+class ScopedTimer
+{
+public:
+	explicit ScopedTimer(Profiler::Timer& timer) :
+		timer(Profiler::instance().isEnabled() ? &timer : nullptr)
+	{
+		if (this->timer != nullptr)
+			start = std::chrono::steady_clock::now();
+	}
+	~ScopedTimer()
+	{
+		if (timer != nullptr)
+			timer->add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start).count());
+	}
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	Profiler::Timer* timer;
+	std::chrono::steady_clock::time_point start;
+};
@@ -14,13 +14,14 @@ public:
     int high_generation; // the upper bound with respect to generation
     int high_expansion; // the upper bound with respect to expansion
     bool collision_v;
+    int goal_id = 0; // index in locs of the next goal to visit
     SIPPNode() : LLNode() {}
     SIPPNode(int loc, int g_val, int h_val, SIPPNode* parent, int timestep, int high_generation, int high_expansion,
-             bool collision_v, int num_of_conflicts) :
+             bool collision_v, int num_of_conflicts, int goal_id) :
             LLNode(loc, g_val, h_val, parent, timestep, num_of_conflicts), high_generation(high_generation),
-            high_expansion(high_expansion), collision_v(collision_v) {}
+            high_expansion(high_expansion), collision_v(collision_v), goal_id(goal_id) {}
     SIPPNode(const SIPPNode& other): LLNode(other), high_generation(other.high_generation), high_expansion(other.high_expansion),
-                                     collision_v(collision_v) {}
+                                     collision_v(other.collision_v), goal_id(other.goal_id) {}
     ~SIPPNode() {}
 
     void copy(const SIPPNode& other) // copy everything except for handles
@@ -29,6 +30,7 @@ public:
         high_generation = other.high_generation;
         high_expansion = other.high_expansion;
         collision_v = other.collision_v;
+        goal_id = other.goal_id;
     }
     // The following is used by for generating the hash value of a nodes
     struct NodeHasher
@@ -38,6 +40,7 @@ public:
             size_t seed = 0;
             boost::hash_combine(seed, n->location);
             boost::hash_combine(seed, n->high_generation);
+            boost::hash_combine(seed, n->goal_id);
             return seed;
         }
     };
@@ -53,7 +56,8 @@ public:
                    (n1 && n2 && n1->location == n2->location &&
                     n1->wait_at_goal == n2->wait_at_goal &&
                     n1->is_goal == n2->is_goal &&
-                    n1->high_generation == n2->high_generation);
+                    n1->high_generation == n2->high_generation &&
+                    n1->goal_id == n2->goal_id);
         }
     };
 };
@@ -61,12 +65,13 @@ public:
 class SIPP: public SingleAgentSolver
 {
 public:
+    // a single search over (location, safe interval, goal index) that visits all of locs in order
     Path findOptimalPath(const set<int>& higher_agents, const vector<Path*>& paths, int agent);
 
     string getName() const { return "SIPP"; }
 
-    SIPP(const Instance& instance, int agent):
-            SingleAgentSolver(instance, agent) {}
+    SIPP(const Instance& instance, int agent, unsigned seed = 0):
+            SingleAgentSolver(instance, agent, seed) {}
 
 private:
     // define typedefs and handles for heap
@@ -81,7 +86,16 @@ private:
     list<SIPPNode*> useless_nodes;
     // Path findNoCollisionPath(const ConstraintTable& constraint_table);
 
-    Path findOptimalPath(const set<int>& higher_agents, const vector<Path*>& paths, int agent, int start_location, int goal_location);
+    // set up by every search: the heuristic of every goal in locs, and the distance from locs[i] through the
+    // following goals to the last one
+    vector<const vector<int>*> goal_heuristics;
+    vector<int> heuristic_to_last;
+
+    int getHeuristic(int location, int goal_id) const
+    {
+        return (*goal_heuristics[goal_id])[location] + heuristic_to_last[goal_id];
+    }
+    int advanceGoalId(int location, int goal_id) const; // goal_id after arriving at location
 
     void updatePath(const LLNode* goal, std::vector<PathEntry> &path);
 
@@ -95,6 +109,9 @@ private:
     {
         num_expanded = 0;
         num_generated = 0;
+        runtime_build_CT = 0;
+        runtime_build_CAT = 0;
+        rng.seed(seed);
     }
     bool dominanceCheck(SIPPNode* new_node);
     void printSearchTree() const;
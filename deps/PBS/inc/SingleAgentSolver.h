@@ -14,6 +14,7 @@ public:
 	bool in_openlist = false;
 	bool wait_at_goal; // the action is to wait at the goal vertex or not. This is used for >lenghth constraints
     bool is_goal = false;
+	uint32_t random_key = 0; // drawn from the owning solver's generator, used to break ties in OPEN and FOCAL
 	// the following is used to comapre nodes in the OPEN list
 	struct compare_node
 	{
@@ -26,7 +27,7 @@ public:
                 {
                     if (n1->h_val == n2->h_val)
                     {
-                        return rand() % 2 == 0;   // break ties randomly
+                        return n1->random_key > n2->random_key;   // break ties randomly
                     }
                     return n1->h_val >= n2->h_val;  // break ties towards smaller h_vals (closer to goal location)
                 }
@@ -47,7 +48,7 @@ public:
                 {
                     if (n1->h_val == n2->h_val)
                     {
-                        return rand() % 2 == 0;   // break ties randomly
+                        return n1->random_key > n2->random_key;   // break ties randomly
                     }
                     return n1->h_val >= n2->h_val;  // break ties towards smaller h_vals (closer to goal location)
                 }
@@ -75,6 +76,7 @@ public:
 		num_of_conflicts = other.num_of_conflicts;
 		wait_at_goal = other.wait_at_goal;
         is_goal = other.is_goal;
+		random_key = other.random_key;
 	}
 };
 
@@ -89,11 +91,16 @@ public:
 	double runtime_build_CAT = 0; // runtime of building conflict avoidance table
 
 	vector<int> locs;
+	int window = MAX_TIMESTEP; // the paths of the higher agents only constrain the timesteps before it
 
-	map< int, vector<int> > my_heuristic;  // this is the precomputed heuristic for this agent
+	map< int, const vector<int>* > my_heuristic;  // this is the precomputed heuristic for this agent, owned by instance.heuristics
 
 	const Instance& instance;
 
+	unsigned seed; // seed of the tie-breaking generator, reset at the beginning of every search
+
+	void setLocations(const vector<int>& locations); // new start and goals, for lifelong planning
+
 	virtual Path findOptimalPath(const set<int>& higher_agents, const vector<Path*>& paths, int agent) = 0;
 	virtual string getName() const = 0;
 
@@ -103,9 +110,11 @@ public:
 	// int getStartLocation() const {return instance.start_locations[agent]; }
 	// int getGoalLocation() const {return instance.goal_locations[agent]; }
 
-	SingleAgentSolver(const Instance& instance, int agent) :
+	SingleAgentSolver(const Instance& instance, int agent, unsigned seed = 0) :
 		instance(instance), //agent(agent), 
-		locs(instance.locations[agent])
+		seed(seed),
+		locs(instance.locations[agent]),
+		rng(seed)
 	{
 		compute_heuristics();
 	}
@@ -115,6 +124,7 @@ public:
 protected:
 	int min_f_val; // minimal f value in OPEN
 	double w = 1; // suboptimal bound
+	std::mt19937 rng; // per-solver generator for the random keys of low-level nodes
 
 	void compute_heuristics();
 };
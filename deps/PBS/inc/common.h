@@ -5,9 +5,11 @@
 #include <set>
 #include <stack>
 #include <ctime>
+#include <chrono>
 #include <fstream>
 #include <iostream>     // std::cout, std::fixed
 #include <iomanip>      // std::setprecision
+#include <random>
 #include <boost/heap/pairing_heap.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
@@ -37,12 +39,19 @@ using std::ofstream;
 using std::cerr;
 using std::string;
 using std::stack;
+using std::chrono::steady_clock;
 
 
 #define MAX_TIMESTEP INT_MAX / 2
 #define MAX_COST INT_MAX / 2
 #define MAX_NODES INT_MAX / 2
 
+// runtimes are wall-clock seconds measured with a monotonic clock
+inline double getElapsedSeconds(const steady_clock::time_point& since)
+{
+	return std::chrono::duration<double>(steady_clock::now() - since).count();
+}
+
 struct PathEntry
 {
 	int location = -1;
@@ -54,6 +63,11 @@ std::ostream& operator<<(std::ostream& os, const Path& path);
 
 bool isSamePath(const Path& p1, const Path& p2);
 
+// Compact path dump: each path is stored as run-length encoded <location, number of timesteps> pairs.
+// The binary variant starts with "PBSP"; the CSV variant has one "agent,length,loc,count,..." row per agent.
+void writeRunLengthPaths(const string& fileName, const vector<Path*>& paths, int num_of_rows, int num_of_cols, bool binary);
+bool readRunLengthPaths(const string& fileName, vector<Path>& paths, int& num_of_rows, int& num_of_cols);
+
 // Only for three-tuples of std::hash-able types for simplicity.
 // You can of course template this struct to allow other hash functions
 /*struct three_tuple_hash {
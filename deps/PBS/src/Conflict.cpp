@@ -1,5 +1,24 @@
+#include <stdexcept>
 #include "Conflict.h"
 
+static const string conflict_selection_names[] = {"RANDOM", "EARLIEST", "CONFLICTS", "MCONSTRAINTS", "FCONSTRAINTS",
+                                                  "WIDTH", "SINGLETONS", "NEWEST"};
+
+string toString(conflict_selection rule)
+{
+    return conflict_selection_names[rule];
+}
+
+conflict_selection conflictSelectionFromString(const string& name)
+{
+    for (int i = RANDOM; i <= NEWEST; i++)
+    {
+        if (conflict_selection_names[i] == name)
+            return (conflict_selection) i;
+    }
+    throw std::invalid_argument("unknown conflict selection rule " + name);
+}
+
 std::ostream& operator<<(std::ostream& os, const Constraint& constraint)
 {
 	os << "<" << constraint.low << " is lower than " << constraint.high << ">";
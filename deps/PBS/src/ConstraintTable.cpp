@@ -40,12 +40,15 @@ void ConstraintTable::insert2CT(size_t loc, int t_min, int t_max)
     }
 }
 
-void ConstraintTable::insert2CT(const Path& path)
+void ConstraintTable::insert2CT(const Path& path, int window)
 {
+    if (window <= 0)
+        return;
     int prev_location = path.front().location;
     int prev_timestep = 0;
+    int horizon = min((int) path.size(), window);
 
-    for (int timestep = 0; timestep < (int) path.size(); timestep++)
+    for (int timestep = 0; timestep < horizon; timestep++)
     {
         auto curr_location = path[timestep].location;
         if (prev_location != curr_location)
@@ -56,7 +59,10 @@ void ConstraintTable::insert2CT(const Path& path)
             prev_timestep = timestep;
         }
     }
-    insert2CT(path.back().location, (int) path.size() - 1, MAX_TIMESTEP);
+    if (horizon < (int) path.size()) // the rest of the path is beyond the window
+        insert2CT(prev_location, prev_timestep, window);
+    else
+        insert2CT(path.back().location, (int) path.size() - 1, window);
 }
 
 void ConstraintTable::insertLandmark(size_t loc, int t)
@@ -71,32 +77,36 @@ void ConstraintTable::insertLandmark(size_t loc, int t)
 }
 
 // build the conflict avoidance table
-void ConstraintTable::insert2CAT(int agent, const vector<Path*>& paths)
+void ConstraintTable::insert2CAT(int agent, const vector<Path*>& paths, int window)
 {
     for (size_t ag = 0; ag < paths.size(); ag++)
     {
         if (ag == agent || paths[ag] == nullptr)
             continue;
-        insert2CAT(*paths[ag]);
+        insert2CAT(*paths[ag], window);
     }
 }
-void ConstraintTable::insert2CAT(const Path& path)
+void ConstraintTable::insert2CAT(const Path& path, int window)
 {
+    if (window <= 0)
+        return;
     if (cat.empty())
     {
         cat.resize(map_size);
         cat_goals.resize(map_size, MAX_TIMESTEP);
     }
 
-    cat_goals[path.back().location] = path.size() - 1;
-    for (auto timestep = (int)path.size() - 1; timestep >= 0; timestep--)
+    int horizon = min((int)path.size(), window);
+    if (horizon == (int)path.size())
+        cat_goals[path.back().location] = path.size() - 1;
+    for (auto timestep = horizon - 1; timestep >= 0; timestep--)
     {
         int loc = path[timestep].location;
         if (cat[loc].size() <= timestep)
             cat[loc].resize(timestep + 1, false);
         cat[loc][timestep] = true;
     }
-    cat_max_timestep = max(cat_max_timestep, (int)path.size() - 1);
+    cat_max_timestep = max(cat_max_timestep, horizon - 1);
 }
 
 
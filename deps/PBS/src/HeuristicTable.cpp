@@ -0,0 +1,68 @@
+#include "HeuristicTable.h"
+#include "Instance.h"
+
+const vector<int>& HeuristicTable::get(const Instance& instance, int goal_location)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = tables.find(goal_location);
+		if (it != tables.end())
+			return *it->second;
+	}
+	// compute outside of the lock; if another thread won the race, its table is kept
+	auto table = std::make_unique<vector<int> >(compute(instance, goal_location));
+	std::lock_guard<std::mutex> lock(mutex);
+	auto ret = tables.emplace(goal_location, std::move(table));
+	return *ret.first->second;
+}
+
+size_t HeuristicTable::size() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return tables.size();
+}
+
+vector<int> HeuristicTable::compute(const Instance& instance, int goal_location)
+{
+	struct Node
+	{
+		int location;
+		int value;
+
+		Node() = default;
+		Node(int location, int value) : location(location), value(value) {}
+		// the following is used to comapre nodes in the OPEN list
+		struct compare_node
+		{
+			// returns true if n1 > n2 (note -- this gives us *min*-heap).
+			bool operator()(const Node& n1, const Node& n2) const
+			{
+				return n1.value >= n2.value;
+			}
+		};  // used by OPEN (heap) to compare nodes (top of the heap has min f-val, && then highest g-val)
+	};
+
+	vector<int> mh(instance.map_size, MAX_TIMESTEP);
+
+	// generate a heap that can save nodes (&& a open_handle)
+	boost::heap::pairing_heap< Node, boost::heap::compare<Node::compare_node> > heap;
+
+	Node root(goal_location, 0);
+	mh[goal_location] = 0;
+	heap.push(root);  // add root to heap
+	while (!heap.empty())
+	{
+		Node curr = heap.top();
+		heap.pop();
+		for (int next_location : instance.getNeighbors(curr.location))
+		{
+			if (mh[next_location] > curr.value + 1)
+			{
+				mh[next_location] = curr.value + 1;
+				Node next(next_location, curr.value + 1);
+				heap.push(next);
+			}
+		}
+	}
+	return mh;
+}
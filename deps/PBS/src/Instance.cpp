@@ -262,10 +262,12 @@ list<int> Instance::getNeighbors(int curr) const
 	return neighbors;
 }
 
-Instance::Instance(vector<bool> map, vector<vector<int>> agents, int nRows, int nCols) :
+Instance::Instance(vector<bool> map, vector<vector<int>> agents, int nRows, int nCols,
+                   shared_ptr<HeuristicTable> heuristics) :
     num_of_rows{nRows},
     num_of_cols{nCols},
     map_size(nRows * nCols),
+    heuristics{heuristics != nullptr ? std::move(heuristics) : make_shared<HeuristicTable>()},
     my_map{std::move(map)},
     num_of_agents{static_cast<int>(agents.size())},
     locations{std::move(agents)}
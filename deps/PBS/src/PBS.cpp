@@ -1,21 +1,43 @@
 ﻿#include <algorithm>    // std::shuffle
 #include <random>      // std::default_random_engine
 #include <chrono>       // std::chrono::system_clock
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
 #include "PBS.h"
 #include "SIPP.h"
+#include "Profiler.h"
 
+static Profiler::Timer& search_timer = Profiler::instance().getTimer("pbs_search");
+static Profiler::Timer& detect_conflicts_timer = Profiler::instance().getTimer("pbs_detect_conflicts");
+static Profiler::Timer& low_level_timer = Profiler::instance().getTimer("pbs_low_level");
 
-PBS::PBS(const Instance& instance, bool sipp, int screen) :
+
+anytime_objective anytimeFromString(const string& name)
+{
+    if (name == "off")
+        return ANYTIME_OFF;
+    if (name == "makespan")
+        return ANYTIME_MAKESPAN;
+    if (name == "soc")
+        return ANYTIME_SOC;
+    throw std::invalid_argument("unknown anytime objective " + name);
+}
+
+PBS::PBS(const Instance& instance, bool sipp, int screen, unsigned seed) :
         screen(screen),
-        num_of_agents(instance.getDefaultNumberOfAgents())
+        rng(seed),
+        num_of_agents(instance.getDefaultNumberOfAgents()),
+        num_of_rows(instance.num_of_rows),
+        num_of_cols(instance.num_of_cols)
 {
-    clock_t t = clock();
+    auto t = steady_clock::now();
 
     search_engines.resize(num_of_agents);
     for (int i = 0; i < num_of_agents; i++) {
-        search_engines[i] = new SIPP(instance, i);}
+        search_engines[i] = new SIPP(instance, i, seed + i);}
 
-    runtime_preprocessing = (double)(clock() - t) / CLOCKS_PER_SEC;
+    runtime_preprocessing = getElapsedSeconds(t);
 }
 
 
@@ -30,32 +52,127 @@ bool PBS::solve(double _time_limit)
         cout << name << ": ";
     }
     // set timer
-    start = clock();
+    start = steady_clock::now();
+    ScopedTimer timer(search_timer);
 
+    base_priorities.clear();
     generateRoot();
+    return runHighLevelSearch();
+}
 
-    while (!open_list.empty())
+void PBS::setWindow(int w)
+{
+    window = w;
+    for (auto engine : search_engines)
+        engine->window = w;
+}
+
+bool PBS::solveWindow(const vector<vector<int>>& goals, int executed, double _time_limit)
+{
+    if ((int)goals.size() != num_of_agents)
+        throw std::invalid_argument("solveWindow needs the goals of " + std::to_string(num_of_agents) + " agents");
+    this->time_limit = _time_limit;
+    start = steady_clock::now();
+    ScopedTimer timer(search_timer);
+
+    // continue from the current solution: the rest of every path and the priorities between unchanged agents
+    bool warm = solution_found;
+    vector<Path> kept_paths(num_of_agents);
+    vector<bool> changed(num_of_agents, true);
+    for (int a = 0; a < num_of_agents; a++)
+    {
+        auto& engine = *search_engines[a];
+        vector<int> locations{engine.locs.front()};
+        if (warm)
+        {
+            const Path& path = *paths[a];
+            size_t t = min((size_t)max(executed, 0), path.size() - 1);
+            kept_paths[a].assign(path.begin() + t, path.end());
+            size_t reached = 1; // goals visited by the executed part of the path
+            for (size_t i = 0; i <= t && reached < engine.locs.size(); i++)
+            {
+                if (path[i].location == engine.locs[reached])
+                    reached++;
+            }
+            changed[a] = !std::equal(engine.locs.begin() + reached, engine.locs.end(), goals[a].begin(), goals[a].end());
+            locations.front() = kept_paths[a].front().location;
+        }
+        locations.insert(locations.end(), goals[a].begin(), goals[a].end());
+        if (locations != engine.locs)
+            engine.setLocations(locations);
+    }
+    if (warm)
+    {
+        base_priorities = priority_graph;
+        for (int a1 = 0; a1 < num_of_agents; a1++)
+        {
+            for (int a2 = 0; a2 < num_of_agents; a2++)
+            {
+                if (changed[a1] || changed[a2])
+                    base_priorities[a1][a2] = false;
+            }
+        }
+    }
+    clear();
+    num_window_replanned = 0;
+
+    if (!warm || !generateWarmRoot(kept_paths, changed))
+    {
+        if (screen > 0 && warm)
+            cout << "The warm root failed, replanning every agent" << endl;
+        clear();
+        base_priorities.clear();
+        num_window_replanned = num_of_agents;
+        if (!generateRoot())
+            return false;
+    }
+    return runHighLevelSearch();
+}
+
+bool PBS::runHighLevelSearch()
+{
+    while (!openListEmpty())
     {
         auto curr = selectNode();
 
         if (terminate(curr)) break;
 
+        if (curr->conflicts.empty()) // anytime mode: a new incumbent, nothing to expand
+            continue;
+        if (isDominatedByIncumbent(*curr))
+        {
+            num_HL_pruned++;
+            curr->clear();
+            continue;
+        }
+
+        auto t = steady_clock::now();
         curr->conflict = chooseConflict(*curr);
+        runtime_choose_conflict += getElapsedSeconds(t);
 
         if (screen > 1)
             cout << "	Expand " << *curr << "	on " << *(curr->conflict) << endl;
 
         assert(!hasHigherPriority(curr->conflict->a1, curr->conflict->a2) &&
                !hasHigherPriority(curr->conflict->a2, curr->conflict->a1) );
-        auto t1 = clock();
+        auto t1 = steady_clock::now();
         vector<Path*> copy(paths);
         generateChild(0, curr, curr->conflict->a1, curr->conflict->a2);
         paths = copy;
         generateChild(1, curr, curr->conflict->a2, curr->conflict->a1);
-        runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
+        runtime_generate_child += getElapsedSeconds(t1);
         pushNodes(curr->children[0], curr->children[1]);
         curr->clear();
     }  // end of while loop
+    if (anytime != ANYTIME_OFF && goal_node != nullptr)
+    { // report the incumbent, not the last expanded node
+        runtime = getElapsedSeconds(start);
+        solution_found = true;
+        solution_cost = goal_node->makespan;
+        update(goal_node);
+        if (screen > 0)
+            printResults();
+    }
     return solution_found;
 }
 
@@ -177,11 +294,12 @@ bool PBS::generateChild(int child_id, PBSNode* parent, int low, int high)
         }
 
         // Find new conflicts
+        auto t = steady_clock::now();
+        ScopedTimer timer(detect_conflicts_timer);
         for (auto a2 = 0; a2 < num_of_agents; a2++)
         {
             if (a2 == a || lookup_table[a2] || higher_agents.count(a2) > 0) // already in to_replan || has higher priority
                 continue;
-            auto t = clock();
             if (hasConflicts(a, a2))
             {
                 node->conflicts.emplace_back(new Conflict(a, a2));
@@ -193,8 +311,8 @@ bool PBS::generateChild(int child_id, PBSNode* parent, int low, int high)
                     lookup_table[a2] = true;
                 }
             }
-            runtime_detect_conflicts += (double)(clock() - t) / CLOCKS_PER_SEC;
         }
+        runtime_detect_conflicts += getElapsedSeconds(t);
     }
     num_HL_generated++;
     node->time_generated = num_HL_generated;
@@ -205,13 +323,16 @@ bool PBS::generateChild(int child_id, PBSNode* parent, int low, int high)
 
 bool PBS::findPathForSingleAgent(PBSNode& node, const set<int>& higher_agents, int a, Path& new_path)
 {
-    clock_t t = clock();
-    new_path = search_engines[a]->findOptimalPath(higher_agents, paths, a);  //TODO: add runtime check to the low level
+    auto t = steady_clock::now();
+    {
+        ScopedTimer timer(low_level_timer);
+        new_path = search_engines[a]->findOptimalPath(higher_agents, paths, a);  //TODO: add runtime check to the low level
+    }
     num_LL_expanded += search_engines[a]->num_expanded;
     num_LL_generated += search_engines[a]->num_generated;
     runtime_build_CT += search_engines[a]->runtime_build_CT;
     runtime_build_CAT += search_engines[a]->runtime_build_CAT;
-    runtime_path_finding += (double)(clock() - t) / CLOCKS_PER_SEC;
+    runtime_path_finding += getElapsedSeconds(t);
     if (new_path.empty())
         return false;
     assert(paths[a] != nullptr && !isSamePath(*paths[a], new_path));
@@ -241,7 +362,10 @@ bool PBS::findPathForSingleAgent(PBSNode& node, const set<int>& higher_agents, i
 inline void PBS::update(PBSNode* node)
 {
     paths.assign(num_of_agents, nullptr);
-    priority_graph.assign(num_of_agents, vector<bool>(num_of_agents, false));
+    if (base_priorities.empty())
+        priority_graph.assign(num_of_agents, vector<bool>(num_of_agents, false));
+    else
+        priority_graph = base_priorities;
     for (auto curr = node; curr != nullptr; curr = curr->parent)
 	{
 		for (auto & path : curr->paths)
@@ -258,16 +382,20 @@ inline void PBS::update(PBSNode* node)
 }
 
 bool PBS::hasConflicts(int a1, int a2) const
+{
+    return getEarliestConflictTimestep(a1, a2) >= 0;
+}
+int PBS::getEarliestConflictTimestep(int a1, int a2) const
 {
 	int min_path_length = (int) (paths[a1]->size() < paths[a2]->size() ? paths[a1]->size() : paths[a2]->size());
-	for (int timestep = 0; timestep < min_path_length; timestep++)
+	for (int timestep = 0; timestep < min(min_path_length, window); timestep++)
 	{
 		int loc1 = paths[a1]->at(timestep).location;
 		int loc2 = paths[a2]->at(timestep).location;
-		if (loc1 == loc2 || (timestep < min_path_length - 1 && loc1 == paths[a2]->at(timestep + 1).location
+		if (loc1 == loc2 || (timestep < min_path_length - 1 && timestep + 1 < window && loc1 == paths[a2]->at(timestep + 1).location
                              && loc2 == paths[a1]->at(timestep + 1).location)) // vertex || edge conflict
 		{
-            return true;
+            return timestep;
 		}
 	}
 	if (paths[a1]->size() != paths[a2]->size())
@@ -275,16 +403,16 @@ bool PBS::hasConflicts(int a1, int a2) const
 		int a1_ = paths[a1]->size() < paths[a2]->size() ? a1 : a2;
 		int a2_ = paths[a1]->size() < paths[a2]->size() ? a2 : a1;
 		int loc1 = paths[a1_]->back().location;
-		for (int timestep = min_path_length; timestep < (int)paths[a2_]->size(); timestep++)
+		for (int timestep = min_path_length; timestep < min((int)paths[a2_]->size(), window); timestep++)
 		{
 			int loc2 = paths[a2_]->at(timestep).location;
 			if (loc1 == loc2)
 			{
-				return true; // target conflict
+				return timestep; // target conflict
 			}
 		}
 	}
-    return false; // conflict-free
+    return -1; // conflict-free
 }
 bool PBS::hasConflicts(int a1, const set<int>& agents) const
 {
@@ -295,13 +423,92 @@ bool PBS::hasConflicts(int a1, const set<int>& agents) const
     }
     return false;
 }
-shared_ptr<Conflict> PBS::chooseConflict(const PBSNode &node) const
+shared_ptr<Conflict> PBS::chooseConflict(const PBSNode &node)
 {
 	if (screen == 3)
 		printConflicts(node);
 	if (node.conflicts.empty())
 		return nullptr;
-    return node.conflicts.back();
+    shared_ptr<Conflict> choose = node.conflicts.back();
+    switch (conflict_seletion_rule)
+    {
+        case RANDOM:
+        {
+            auto it = node.conflicts.begin();
+            std::advance(it, std::uniform_int_distribution<size_t>(0, node.conflicts.size() - 1)(rng));
+            choose = *it;
+            break;
+        }
+        case EARLIEST:
+        {
+            int earliest = MAX_TIMESTEP;
+            for (const auto& conflict : node.conflicts)
+            {
+                int t = getEarliestConflictTimestep(conflict->a1, conflict->a2);
+                if (t >= 0 && t < earliest)
+                {
+                    earliest = t;
+                    choose = conflict;
+                }
+            }
+            break;
+        }
+        case CONFLICTS: // the conflict whose agents are involved in the most conflicts
+        {
+            vector<int> num_of_conflicts(num_of_agents, 0);
+            for (const auto& conflict : node.conflicts)
+            {
+                num_of_conflicts[conflict->a1]++;
+                num_of_conflicts[conflict->a2]++;
+            }
+            int best = -1;
+            for (const auto& conflict : node.conflicts)
+            {
+                if (num_of_conflicts[conflict->a1] + num_of_conflicts[conflict->a2] >= best)
+                {
+                    best = num_of_conflicts[conflict->a1] + num_of_conflicts[conflict->a2];
+                    choose = conflict;
+                }
+            }
+            break;
+        }
+        case MCONSTRAINTS: // the conflict whose agents already have the most priority relations
+        case FCONSTRAINTS: // the conflict whose agents have the fewest priority relations
+        {
+            vector<int> num_of_priorities(num_of_agents, -1);
+            int best = -1;
+            for (const auto& conflict : node.conflicts)
+            {
+                for (int a : {conflict->a1, conflict->a2})
+                {
+                    if (num_of_priorities[a] < 0)
+                        num_of_priorities[a] = getNumOfPriorities(a);
+                }
+                int value = num_of_priorities[conflict->a1] + num_of_priorities[conflict->a2];
+                if (conflict_seletion_rule == FCONSTRAINTS)
+                    value = 2 * num_of_agents - value;
+                if (value >= best)
+                {
+                    best = value;
+                    choose = conflict;
+                }
+            }
+            break;
+        }
+        default: // NEWEST; WIDTH and SINGLETONS rely on MDDs, which PBS does not build
+            break;
+    }
+    return choose;
+}
+int PBS::getNumOfPriorities(int agent) const
+{
+    int rst = 0;
+    for (int i = 0; i < num_of_agents; i++)
+    {
+        if (priority_graph[agent][i] || priority_graph[i][agent])
+            rst++;
+    }
+    return rst;
 }
 int PBS::getSumOfCosts() const
 {
@@ -313,7 +520,12 @@ int PBS::getSumOfCosts() const
 inline void PBS::pushNode(PBSNode* node)
 {
 	// update handles
-    open_list.push(node);
+	if (search_strategy == HL_BEST_COST || search_strategy == HL_BEST_MAKESPAN)
+		open_heap.push(node);
+	else if (search_strategy == HL_LDS && node->discrepancies > discrepancy_limit)
+		deferred_list.push_back(node);
+	else
+		open_list.push(node);
 	allNodes_table.push_back(node);
 }
 void PBS::pushNodes(PBSNode* n1, PBSNode* n2)
@@ -322,11 +534,13 @@ void PBS::pushNodes(PBSNode* n1, PBSNode* n2)
     {
         if (n1->cost < n2->cost)
         {
+            n2->discrepancies++;
             pushNode(n2);
             pushNode(n1);
         }
         else
         {
+            n1->discrepancies++;
             pushNode(n1);
             pushNode(n2);
         }
@@ -341,10 +555,45 @@ void PBS::pushNodes(PBSNode* n1, PBSNode* n2)
     }
 }
 
+bool PBS::openListEmpty()
+{
+    if (search_strategy == HL_LDS && open_list.empty() && !deferred_list.empty())
+    { // restart depth-first from the nodes that exceeded the previous limit
+        discrepancy_limit++;
+        num_LDS_restarts++;
+        for (auto node : deferred_list)
+        {
+            assert(node->discrepancies <= discrepancy_limit);
+            open_list.push(node);
+        }
+        deferred_list.clear();
+        if (screen > 1)
+            cout << "LDS restart with discrepancy limit " << discrepancy_limit << endl;
+    }
+    return open_list.empty() && open_heap.empty();
+}
+
+void PBS::clearOpenList()
+{
+    open_list = stack<PBSNode*>();
+    open_heap.clear();
+    deferred_list.clear();
+    discrepancy_limit = 0;
+}
+
 PBSNode* PBS::selectNode()
 {
-	PBSNode* curr = open_list.top();
-    open_list.pop();
+    PBSNode* curr;
+    if (!open_heap.empty())
+    {
+        curr = open_heap.top();
+        open_heap.pop();
+    }
+    else
+    {
+        curr = open_list.top();
+        open_list.pop();
+    }
     update(curr);
     num_HL_expanded++;
     curr->time_expanded = num_HL_expanded;
@@ -429,7 +678,7 @@ void PBS::saveResults(const string &fileName, const string &instanceName) const
 		addHeads << "runtime\t#high-level expanded\t#high-level generated\t#low-level expanded\t#low-level generated\t" <<
 			"solution cost\troot g value\t" <<
 			"runtime of detecting conflicts\truntime of building constraint tables\truntime of building CATs\t" <<
-			"runtime of path finding\truntime of generating child nodes\t" <<
+			"runtime of path finding\truntime of generating child nodes\truntime of choosing conflicts\t" <<
 			"preprocessing runtime\tsolver name\tinstance name" << endl;
 		addHeads.close();
 	}
@@ -441,7 +690,7 @@ void PBS::saveResults(const string &fileName, const string &instanceName) const
           solution_cost << "\t" << dummy_start->cost << "\t" <<
 
 		runtime_detect_conflicts << "\t" << runtime_build_CT << "\t" << runtime_build_CAT << "\t" <<
-		runtime_path_finding << "\t" << runtime_generate_child << "\t" <<
+		runtime_path_finding << "\t" << runtime_generate_child << "\t" << runtime_choose_conflict << "\t" <<
 
 		runtime_preprocessing << "\t" << getSolverName() << "\t" << instanceName << endl;
 	stats.close();
@@ -522,20 +771,33 @@ void PBS::savePaths(const string &fileName) const
 {
     std::ofstream output;
     output.open(fileName, std::ios::out);
-    output << "agent\tcost\tpath" << endl;
+    writePaths(output);
+    output.close();
+}
+
+void PBS::saveRunLengthPaths(const string &fileName, bool binary) const
+{
+    writeRunLengthPaths(fileName, paths, num_of_rows, num_of_cols, binary);
+}
+
+void PBS::writePaths(std::ostream& os) const
+{
+    // build the whole text first, so that it reaches the stream with a single write
+    std::ostringstream output;
+    output << "agent\tcost\tpath\n";
     for (int i = 0; i < num_of_agents; i++)
     {
         output << i << "\t" << paths[i]->size() << "\t";
         for (const auto & t : *paths[i]) {
-            output << "(" << search_engines[0]->instance.getRowCoordinate(t.location)
-                   << "," << search_engines[0]->instance.getColCoordinate(t.location) << ")";
+            output << "(" << t.location / num_of_cols << "," << t.location % num_of_cols << ")";
             if (t.location != paths[i]->back().location) {
                 output << "->";
             }
         }
-        output << endl;
+        output << "\n";
     }
-    output.close();
+    os << output.str();
+    os.flush();
 }
 
 void PBS::printConflicts(const PBSNode &curr)
@@ -549,15 +811,32 @@ void PBS::printConflicts(const PBSNode &curr)
 
 string PBS::getSolverName() const
 {
-	return "PBS with " + search_engines[0]->getName();
+	return "PBS (" + toString(search_strategy) + ", " + toString(conflict_seletion_rule) + ") with " +
+        search_engines[0]->getName();
 }
 
 
 bool PBS::terminate(PBSNode* curr)
 {
-	runtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+	runtime = getElapsedSeconds(start);
 	if (curr->conflicts.empty()) //no conflicts
 	{// found a solution
+		if (anytime != ANYTIME_OFF)
+		{
+			if (goal_node == nullptr || getObjective(*curr) < getObjective(*goal_node))
+			{
+				solution_found = true;
+				goal_node = curr;
+				solution_cost = goal_node->makespan;
+				num_solutions++;
+				if (screen > 0)
+					cout << "Improved solution at " << runtime << "s: makespan = " << curr->makespan
+						 << ", sum of costs = " << curr->cost << endl;
+				if (on_solution)
+					on_solution(runtime, curr->makespan, curr->cost, paths);
+			}
+			return runtime > time_limit || num_HL_expanded > (uint64_t)node_limit;
+		}
 		solution_found = true;
 		goal_node = curr;
 		solution_cost = goal_node->makespan;
@@ -567,6 +846,8 @@ bool PBS::terminate(PBSNode* curr)
 	}
 	if (runtime > time_limit || num_HL_expanded > node_limit)
 	{   // time/node out
+		if (goal_node != nullptr) // anytime mode keeps the incumbent
+			return true;
 		solution_cost = -1;
 		solution_found = false;
         if (screen > 0) // 1 || 2
@@ -577,6 +858,20 @@ bool PBS::terminate(PBSNode* curr)
 }
 
 
+int PBS::getObjective(const PBSNode& node) const
+{
+	if (anytime == ANYTIME_SOC)
+		return node.cost;
+	return (int)node.makespan;
+}
+
+// the makespan and sum of costs of a node are not admissible bounds for its subtree,
+// so this is a greedy branch-and-bound that trades completeness for fewer expansions
+bool PBS::isDominatedByIncumbent(const PBSNode& node) const
+{
+	return anytime != ANYTIME_OFF && goal_node != nullptr && getObjective(node) >= getObjective(*goal_node);
+}
+
 bool PBS::generateRoot()
 {    
 	auto root = new PBSNode();
@@ -589,7 +884,11 @@ bool PBS::generateRoot()
     {
         //CAT cat(dummy_start->makespan + 1);  // initialized to false
         //updateReservationTable(cat, i, *dummy_start);
-        auto new_path = search_engines[i]->findOptimalPath(higher_agents, paths, i);
+        Path new_path;
+        {
+            ScopedTimer timer(low_level_timer);
+            new_path = search_engines[i]->findOptimalPath(higher_agents, paths, i);
+        }
         num_LL_expanded += search_engines[i]->num_expanded;
         num_LL_generated += search_engines[i]->num_generated;
         if (new_path.empty())
@@ -602,19 +901,22 @@ bool PBS::generateRoot()
         root->makespan = max(root->makespan, new_path.size() - 1);
         root->cost += (int)new_path.size() - 1;
     }
-    auto t = clock();
+    auto t = steady_clock::now();
 	root->depth = 0;
-    for (int a1 = 0; a1 < num_of_agents; a1++)
     {
-        for (int a2 = a1 + 1; a2 < num_of_agents; a2++)
+        ScopedTimer timer(detect_conflicts_timer);
+        for (int a1 = 0; a1 < num_of_agents; a1++)
         {
-            if(hasConflicts(a1, a2))
+            for (int a2 = a1 + 1; a2 < num_of_agents; a2++)
             {
-                root->conflicts.emplace_back(new Conflict(a1, a2));
+                if(hasConflicts(a1, a2))
+                {
+                    root->conflicts.emplace_back(new Conflict(a1, a2));
+                }
             }
         }
     }
-    runtime_detect_conflicts += (double)(clock() - t) / CLOCKS_PER_SEC;
+    runtime_detect_conflicts += getElapsedSeconds(t);
     num_HL_generated++;
     root->time_generated = num_HL_generated;
     if (screen > 1)
@@ -625,9 +927,105 @@ bool PBS::generateRoot()
 	return true;
 }
 
+// the root of solveWindow, planned like prioritized planning without recording the priorities: in priority order,
+// an unchanged agent keeps the rest of its path unless it collides with the paths planned so far, then the changed
+// agents are planned one by one around them. An agent without such a path only avoids its higher agents (the changed
+// agents have none) and the search resolves its collisions
+bool PBS::generateWarmRoot(vector<Path>& kept_paths, const vector<bool>& changed)
+{
+    priority_graph = base_priorities;
+    topologicalSort(ordered_agents);
+
+    auto root = new PBSNode();
+    paths.assign(num_of_agents, nullptr);
+    for (int a = 0; a < num_of_agents; a++)
+    {
+        root->paths.emplace_back(a, std::move(kept_paths[a]));
+        paths[a] = &root->paths.back().second;
+    }
+
+    set<int> planned;
+    for (auto p = ordered_agents.begin(); p != ordered_agents.end(); ++p)
+    {
+        int a = *p;
+        if (changed[a])
+            continue;
+        set<int> higher_agents;
+        getHigherPriorityAgents(std::make_reverse_iterator(std::next(p)), higher_agents);
+        if (hasConflicts(a, planned) && !replanInRoot(a, planned) &&
+            hasConflicts(a, higher_agents) && !replanInRoot(a, higher_agents))
+        {
+            delete root;
+            paths.clear();
+            return false;
+        }
+        planned.insert(a);
+    }
+    for (int a = 0; a < num_of_agents; a++)
+    {
+        if (!changed[a])
+            continue;
+        if (!replanInRoot(a, planned) && !replanInRoot(a, set<int>()))
+        {
+            delete root;
+            paths.clear();
+            return false;
+        }
+        planned.insert(a);
+    }
+
+    root->cost = 0;
+    for (const auto& path : paths)
+    {
+        root->makespan = max(root->makespan, path->size() - 1);
+        root->cost += (int)path->size() - 1;
+    }
+    auto t = steady_clock::now();
+    {
+        ScopedTimer timer(detect_conflicts_timer);
+        for (int a1 = 0; a1 < num_of_agents; a1++)
+        {
+            for (int a2 = a1 + 1; a2 < num_of_agents; a2++)
+            {
+                if (hasConflicts(a1, a2))
+                    root->conflicts.emplace_back(new Conflict(a1, a2));
+            }
+        }
+    }
+    runtime_detect_conflicts += getElapsedSeconds(t);
+    num_HL_generated++;
+    root->time_generated = num_HL_generated;
+    if (screen > 1)
+        cout << "Generate " << *root << endl;
+    pushNode(root);
+    dummy_start = root;
+    return true;
+}
+
+bool PBS::replanInRoot(int a, const set<int>& higher_agents)
+{
+    Path new_path;
+    {
+        ScopedTimer timer(low_level_timer);
+        new_path = search_engines[a]->findOptimalPath(higher_agents, paths, a);
+    }
+    num_LL_expanded += search_engines[a]->num_expanded;
+    num_LL_generated += search_engines[a]->num_generated;
+    if (new_path.empty())
+        return false;
+    std::swap(*paths[a], new_path);
+    if (hasConflicts(a, higher_agents)) // keep the priorities consistent
+    {
+        std::swap(*paths[a], new_path);
+        return false;
+    }
+    num_window_replanned++;
+    return true;
+}
+
 inline void PBS::releaseNodes()
 {
-    // TODO:: clear open_list
+    clearOpenList();
 	for (auto& node : allNodes_table)
 		delete node;
 	allNodes_table.clear();
@@ -668,7 +1066,7 @@ bool PBS::validateSolution() const
 		for (int a2 = a1 + 1; a2 < num_of_agents; a2++)
 		{
 			size_t min_path_length = paths[a1]->size() < paths[a2]->size() ? paths[a1]->size() : paths[a2]->size();
-			for (size_t timestep = 0; timestep < min_path_length; timestep++)
+			for (size_t timestep = 0; timestep < min_path_length && (int)timestep < window; timestep++)
 			{
 				int loc1 = paths[a1]->at(timestep).location;
 				int loc2 = paths[a2]->at(timestep).location;
@@ -677,7 +1075,7 @@ bool PBS::validateSolution() const
 					cout << "Agents " << a1 << " && " << a2 << " collides at " << loc1 << " at timestep " << timestep << endl;
 					return false;
 				}
-				else if (timestep < min_path_length - 1
+				else if (timestep < min_path_length - 1 && (int)timestep + 1 < window
 					&& loc1 == paths[a2]->at(timestep + 1).location
 					&& loc2 == paths[a1]->at(timestep + 1).location)
 				{
@@ -691,7 +1089,7 @@ bool PBS::validateSolution() const
 				int a1_ = paths[a1]->size() < paths[a2]->size() ? a1 : a2;
 				int a2_ = paths[a1]->size() < paths[a2]->size() ? a2 : a1;
 				int loc1 = paths[a1_]->back().location;
-				for (size_t timestep = min_path_length; timestep < paths[a2_]->size(); timestep++)
+				for (size_t timestep = min_path_length; timestep < paths[a2_]->size() && (int)timestep < window; timestep++)
 				{
 					int loc2 = paths[a2_]->at(timestep).location;
 					if (loc1 == loc2)
@@ -809,17 +1207,5 @@ bool PBS::hasHigherPriority(int low, int high) const // return true if agent low
 }
 
 void PBS::printPaths() const {
-    std::cout << "agent\tcost\tpath" << endl;
-    for (int i = 0; i < num_of_agents; i++)
-    {
-        std::cout << i << "\t" << paths[i]->size() << "\t";
-        for (const auto & t : *paths[i]) {
-            std::cout << "(" << search_engines[0]->instance.getRowCoordinate(t.location)
-                   << "," << search_engines[0]->instance.getColCoordinate(t.location) << ")";
-            if (t.location != paths[i]->back().location) {
-                std::cout << "->";
-            }
-        }
-        std::cout << endl;
-    }
+    writePaths(std::cout);
 }
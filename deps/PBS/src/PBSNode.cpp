@@ -1,5 +1,23 @@
+#include <stdexcept>
 #include "PBSNode.h"
 
+static const string high_level_search_names[] = {"DFS", "BEST_COST", "BEST_MAKESPAN", "LDS"};
+
+string toString(high_level_search strategy)
+{
+    return high_level_search_names[strategy];
+}
+
+high_level_search highLevelSearchFromString(const string& name)
+{
+    for (int i = HL_DFS; i <= HL_LDS; i++)
+    {
+        if (high_level_search_names[i] == name)
+            return (high_level_search) i;
+    }
+    throw std::invalid_argument("unknown high-level search " + name);
+}
+
 
 void PBSNode::clear()
 {
@@ -0,0 +1,78 @@
+#include <sstream>
+#include <iomanip>
+#include "Profiler.h"
+
+void Profiler::Timer::add(uint64_t ns)
+{
+	count.fetch_add(1, std::memory_order_relaxed);
+	total_ns.fetch_add(ns, std::memory_order_relaxed);
+	auto prev = max_ns.load(std::memory_order_relaxed);
+	while (prev < ns && !max_ns.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) { }
+}
+
+Profiler& Profiler::instance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Timer& Profiler::getTimer(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = timer_index.find(name);
+	if (it != timer_index.end())
+		return *it->second;
+	timers.emplace_back(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+	timer_index[name] = &timers.back().second;
+	return timers.back().second;
+}
+
+Profiler::Counter& Profiler::getCounter(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = counter_index.find(name);
+	if (it != counter_index.end())
+		return *it->second;
+	counters.emplace_back(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+	counter_index[name] = &counters.back().second;
+	return counters.back().second;
+}
+
+void Profiler::reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto& timer : timers)
+	{
+		timer.second.count = 0;
+		timer.second.total_ns = 0;
+		timer.second.max_ns = 0;
+	}
+	for (auto& counter : counters)
+		counter.second.value = 0;
+}
+
+std::string Profiler::toJson() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::ostringstream os;
+	os << std::setprecision(9) << "{\"timers\":{";
+	bool first = true;
+	for (const auto& timer : timers)
+	{
+		if (timer.second.count == 0)
+			continue;
+		os << (first ? "" : ",") << "\"" << timer.first << "\":{\"count\":" << timer.second.count
+		   << ",\"total\":" << (double)timer.second.total_ns / 1e9
+		   << ",\"max\":" << (double)timer.second.max_ns / 1e9 << "}";
+		first = false;
+	}
+	os << "},\"counters\":{";
+	first = true;
+	for (const auto& counter : counters)
+	{
+		os << (first ? "" : ",") << "\"" << counter.first << "\":" << counter.second.value;
+		first = false;
+	}
+	os << "}}";
+	return os.str();
+}
@@ -1,4 +1,9 @@
 #include "SIPP.h"
+#include "Profiler.h"
+
+static Profiler::Timer& build_CT_timer = Profiler::instance().getTimer("sipp_build_ct");
+static Profiler::Timer& build_CAT_timer = Profiler::instance().getTimer("sipp_build_cat");
+static Profiler::Timer& search_timer = Profiler::instance().getTimer("sipp_search");
 
 void SIPP::updatePath(const LLNode* goal, vector<PathEntry> &path)
 {
@@ -20,41 +25,64 @@ void SIPP::updatePath(const LLNode* goal, vector<PathEntry> &path)
     path[0].location = curr->location;
 }
 
-Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& paths, int agent, int start_location, int goal_location)
+int SIPP::advanceGoalId(int location, int goal_id) const
+{
+    while (goal_id + 1 < (int)locs.size() && location == locs[goal_id])
+        goal_id++;
+    return goal_id;
+}
+
+Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& paths, int agent)
 {
     reset();
+    int start_location = locs.front();
+    int goal_location = locs.back();
+    int last_goal_id = (int)locs.size() - 1;
 
     // build constraint table
-    auto t = clock();
+    auto t = steady_clock::now();
     ConstraintTable constraint_table(instance.num_of_cols, instance.map_size);
-    for (int a : higher_agents)
     {
-        if (paths[a] == nullptr) {continue;}
-        constraint_table.insert2CT(*paths[a]);
+        ScopedTimer timer(build_CT_timer);
+        for (int a : higher_agents)
+        {
+            if (paths[a] == nullptr) {continue;}
+            constraint_table.insert2CT(*paths[a], window);
+        }
     }
-    runtime_build_CT = (double)(clock() - t) / CLOCKS_PER_SEC;
+    runtime_build_CT += getElapsedSeconds(t);
 
     int holding_time = constraint_table.getHoldingTime(goal_location, constraint_table.length_min);
 
-    t = clock();
-    constraint_table.insert2CAT(agent, paths);
-    runtime_build_CAT = (double)(clock() - t) / CLOCKS_PER_SEC;
+    t = steady_clock::now();
+    {
+        ScopedTimer timer(build_CAT_timer);
+        constraint_table.insert2CAT(agent, paths, window);
+    }
+    runtime_build_CAT += getElapsedSeconds(t);
 
+    ScopedTimer timer(search_timer);
+    goal_heuristics.resize(locs.size());
+    heuristic_to_last.assign(locs.size(), 0);
+    for (int i = last_goal_id; i >= 0; i--)
+    {
+        goal_heuristics[i] = my_heuristic[locs[i]];
+        if (i < last_goal_id)
+            heuristic_to_last[i] = (*goal_heuristics[i + 1])[locs[i]] + heuristic_to_last[i + 1];
+    }
     // build reservation table
     ReservationTable reservation_table(constraint_table, goal_location);
 
     Path path;
-    num_expanded = 0;
-    num_generated = 0;
     Interval interval = reservation_table.get_first_safe_interval(start_location);
     if (get<0>(interval) > 0)
         return path;
-    
-    // change agent for loc (pass idx of loc || value?)
 
     // generate start && add it to the OPEN list
-    auto start = new SIPPNode(start_location, 0, max(my_heuristic[goal_location][start_location], holding_time), nullptr, 0,
-                              get<1>(interval), get<1>(interval), get<2>(interval), get<2>(interval));
+    int start_goal_id = advanceGoalId(start_location, locs.size() > 1 ? 1 : 0);
+    auto start = new SIPPNode(start_location, 0, max(getHeuristic(start_location, start_goal_id), holding_time), nullptr, 0,
+                              get<1>(interval), get<1>(interval), get<2>(interval), get<2>(interval), start_goal_id);
+    start->random_key = rng();
     min_f_val = max(holding_time, (int)start->getFVal());
     pushNodeToOpen(start);
 
@@ -65,7 +93,8 @@ Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& p
         num_expanded++;
 
         // check if the popped node is a goal node
-        if (curr->location == goal_location && // arrive at the goal location
+        if (curr->goal_id == last_goal_id && // visited the other goals
+            curr->location == goal_location && // arrive at the goal location
             !curr->wait_at_goal && // not wait at the goal location
             curr->timestep >= holding_time) // the agent can hold the goal location afterward
         {
@@ -75,6 +104,7 @@ Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& p
 
         for (int next_location : instance.getNeighbors(curr->location)) // move to neighboring locations
         {
+            int next_goal_id = advanceGoalId(next_location, curr->goal_id);
             for (auto & i : reservation_table.get_safe_intervals(
                     curr->location, next_location, curr->timestep + 1, curr->high_expansion + 1))
             {
@@ -84,14 +114,16 @@ Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& p
                                 
                 // compute cost to next_id via curr node
                 int next_g_val = next_timestep;
-                int next_h_val = max(my_heuristic[goal_location][next_location], curr->getFVal() - next_g_val);  // path max
+                int next_h_val = max(getHeuristic(next_location, next_goal_id), curr->getFVal() - next_g_val);  // path max
                 if (next_g_val + next_h_val > reservation_table.constraint_table.length_max)
                     continue;
                 int next_conflicts = curr->num_of_conflicts +
                                      (int)curr->collision_v * max(next_timestep - curr->timestep - 1, 0) +
                                      + (int)next_v_collision + (int)next_e_collision;
                 auto next = new SIPPNode(next_location, next_g_val, next_h_val, curr, next_timestep,
-                                         next_high_generation, next_high_expansion, next_v_collision, next_conflicts);
+                                         next_high_generation, next_high_expansion, next_v_collision, next_conflicts,
+                                         next_goal_id);
+                next->random_key = rng();
                 if (dominanceCheck(next))
                     pushNodeToOpen(next);
                 else
@@ -110,8 +142,10 @@ Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& p
                                    (int)curr->collision_v * max(next_timestep - curr->timestep - 1, 0) // wait time
                                    + (int)get<2>(interval);
             auto next = new SIPPNode(curr->location, next_timestep, next_h_val, curr, next_timestep,
-                                     get<1>(interval), get<1>(interval), get<2>(interval), next_collisions);
-            if (curr->location == goal_location)
+                                     get<1>(interval), get<1>(interval), get<2>(interval), next_collisions,
+                                     curr->goal_id);
+            next->random_key = rng();
+            if (curr->location == goal_location && curr->goal_id == last_goal_id)
                 next->wait_at_goal = true;
             if (dominanceCheck(next))
                 pushNodeToOpen(next);
@@ -123,47 +157,6 @@ Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& p
     return path;
 }
 
-Path SIPP::findOptimalPath(const set<int>& higher_agents, const vector<Path*>& paths, int agent) {
-    Path total_path;
-
-    if (locs.size() == 1) {
-        int start_location = locs[0];
-        int goal_location = locs[0];
-
-        total_path = findOptimalPath(higher_agents, paths, agent, start_location, goal_location);
-        return total_path;
-    }
-
-    int start_location = locs[0];
-    int goal_location = locs[1];
-
-    Path p = findOptimalPath(higher_agents, paths, agent, start_location, goal_location);
-    for (int j = 0; j < p.size() ; j++) {
-        total_path.push_back(p[j]);
-    }
-    
-    for (int i = 2; i < locs.size(); i++) {
-        vector<Path*> forward_paths;
-        for (auto& pts: paths) {
-            if (pts->size() >= total_path.size()) {
-                Path *newPath = new Path(pts->begin() + total_path.size() - 1, pts->end());
-                forward_paths.push_back(newPath);
-            } else {
-                forward_paths.push_back(nullptr); 
-            }
-        }
-
-        start_location = goal_location;
-        goal_location = locs[i];
-
-        p = findOptimalPath(higher_agents, forward_paths, agent, start_location, goal_location);
-        for (int j = 1; j < p.size() ; j++) {
-            total_path.push_back(p[j]);
-        }
-    }
-    return total_path;
-}
-
 void SIPP::updateFocalList()
 {
     auto open_head = open_list.top();
@@ -1,4 +1,7 @@
 #include "SingleAgentSolver.h"
+#include "Profiler.h"
+
+static Profiler::Timer& heuristics_timer = Profiler::instance().getTimer("compute_heuristics");
 
 
 list<int> SingleAgentSolver::getNextLocations(int curr) const // including itself && its neighbors
@@ -9,50 +12,16 @@ list<int> SingleAgentSolver::getNextLocations(int curr) const // including itsel
 }
 
 
-void SingleAgentSolver::compute_heuristics()
+void SingleAgentSolver::setLocations(const vector<int>& locations)
 {
-	struct Node
-	{
-		int location;
-		int value;
-
-		Node() = default;
-		Node(int location, int value) : location(location), value(value) {}
-		// the following is used to comapre nodes in the OPEN list
-		struct compare_node
-		{
-			// returns true if n1 > n2 (note -- this gives us *min*-heap).
-			bool operator()(const Node& n1, const Node& n2) const
-			{
-				return n1.value >= n2.value;
-			}
-		};  // used by OPEN (heap) to compare nodes (top of the heap has min f-val, && then highest g-val)
-	};
-
-	vector <int> mh;
-	for (int i = 0; i < locs.size(); i++) {
-		mh.resize(instance.map_size, MAX_TIMESTEP);
-	
-		// generate a heap that can save nodes (&& a open_handle)
-		boost::heap::pairing_heap< Node, boost::heap::compare<Node::compare_node> > heap;
+	locs = locations;
+	my_heuristic.clear();
+	compute_heuristics();
+}
 
-		Node root(locs[i], 0);
-		mh[locs[i]] = 0;
-		heap.push(root);  // add root to heap
-		while (!heap.empty())
-		{
-			Node curr = heap.top();
-			heap.pop();
-			for (int next_location : instance.getNeighbors(curr.location))
-			{
-				if (mh[next_location] > curr.value + 1)
-				{
-					mh[next_location] = curr.value + 1;
-					Node next(next_location, curr.value + 1);
-					heap.push(next);
-				}
-			}
-		}
-		my_heuristic.insert({locs[i], mh});
-	}
+void SingleAgentSolver::compute_heuristics()
+{
+	ScopedTimer timer(heuristics_timer);
+	for (int loc : locs)
+		my_heuristic[loc] = &instance.heuristics->get(instance, loc);
 }
@@ -1,5 +1,10 @@
+#include <cstring>
+#include <sstream>
 #include "common.h"
 
+static constexpr char path_magic[4] = {'P', 'B', 'S', 'P'};
+static constexpr uint32_t path_format_version = 1;
+
 std::ostream& operator<<(std::ostream& os, const Path& path)
 {
 	for (const auto& state : path)
@@ -21,3 +26,129 @@ bool isSamePath(const Path& p1, const Path& p2)
 	}
 	return true;
 }
+
+
+// <location, number of consecutive timesteps at the location>
+static vector<pair<uint32_t, uint32_t> > encodeRuns(const Path& path)
+{
+	vector<pair<uint32_t, uint32_t> > runs;
+	for (const auto& state : path)
+	{
+		if (!runs.empty() && runs.back().first == (uint32_t)state.location)
+			runs.back().second++;
+		else
+			runs.emplace_back(state.location, 1);
+	}
+	return runs;
+}
+
+static void appendWord(string& buffer, uint32_t word)
+{
+	buffer.append(reinterpret_cast<const char*>(&word), sizeof(word));
+}
+
+void writeRunLengthPaths(const string& fileName, const vector<Path*>& paths, int num_of_rows, int num_of_cols, bool binary)
+{
+	string buffer;
+	if (binary)
+	{
+		buffer.append(path_magic, sizeof(path_magic));
+		appendWord(buffer, path_format_version);
+		appendWord(buffer, num_of_rows);
+		appendWord(buffer, num_of_cols);
+		appendWord(buffer, (uint32_t)paths.size());
+		for (const auto& path : paths)
+		{
+			auto runs = encodeRuns(*path);
+			appendWord(buffer, (uint32_t)runs.size());
+			for (const auto& run : runs)
+			{
+				appendWord(buffer, run.first);
+				appendWord(buffer, run.second);
+			}
+		}
+	}
+	else
+	{
+		std::ostringstream output;
+		output << num_of_rows << "," << num_of_cols << "," << paths.size() << "\n";
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			output << i << "," << paths[i]->size();
+			for (const auto& run : encodeRuns(*paths[i]))
+				output << "," << run.first << "," << run.second;
+			output << "\n";
+		}
+		buffer = output.str();
+	}
+	ofstream file(fileName, std::ios::out | std::ios::binary);
+	file.write(buffer.data(), (std::streamsize)buffer.size());
+}
+
+bool readRunLengthPaths(const string& fileName, vector<Path>& paths, int& num_of_rows, int& num_of_cols)
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+	string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	paths.clear();
+
+	if (buffer.size() >= sizeof(path_magic) && memcmp(buffer.data(), path_magic, sizeof(path_magic)) == 0)
+	{
+		size_t offset = sizeof(path_magic);
+		auto readWord = [&buffer, &offset](uint32_t& word)
+		{
+			if (offset + sizeof(word) > buffer.size())
+				return false;
+			memcpy(&word, buffer.data() + offset, sizeof(word));
+			offset += sizeof(word);
+			return true;
+		};
+		uint32_t version, rows, cols, num_of_paths;
+		if (!readWord(version) || version != path_format_version ||
+			!readWord(rows) || !readWord(cols) || !readWord(num_of_paths))
+			return false;
+		num_of_rows = (int)rows;
+		num_of_cols = (int)cols;
+		paths.resize(num_of_paths);
+		for (auto& path : paths)
+		{
+			uint32_t num_of_runs, location, count;
+			if (!readWord(num_of_runs))
+				return false;
+			for (uint32_t r = 0; r < num_of_runs; r++)
+			{
+				if (!readWord(location) || !readWord(count))
+					return false;
+				path.insert(path.end(), count, PathEntry((int)location));
+			}
+		}
+		return true;
+	}
+
+	std::istringstream input(buffer);
+	string line;
+	char comma;
+	size_t num_of_paths;
+	if (!std::getline(input, line))
+		return false;
+	std::istringstream header(line);
+	if (!(header >> num_of_rows >> comma >> num_of_cols >> comma >> num_of_paths))
+		return false;
+	paths.resize(num_of_paths);
+	while (std::getline(input, line))
+	{
+		std::istringstream row(line);
+		size_t agent, length;
+		if (!(row >> agent >> comma >> length) || agent >= num_of_paths)
+			return false;
+		auto& path = paths[agent];
+		path.reserve(length);
+		int location, count;
+		while (row >> comma >> location >> comma >> count)
+			path.insert(path.end(), count, PathEntry(location));
+		if (path.size() != length)
+			return false;
+	}
+	return true;
+}
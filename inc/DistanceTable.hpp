@@ -0,0 +1,38 @@
+#ifndef CMAPD_DISTANCETABLE_HPP
+#define CMAPD_DISTANCETABLE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Shortest path lengths between grid cells, stored as one flat row-major table over the tabled cells.
+// Two on-disk forms are supported:
+//  - .npy: the full (rows, cols, rows, cols) matrix of doubles, every cell is tabled;
+//  - .npz: an endpoint table with "cells" (uint32 cell indices) and "distances" (int32, cells x cells), for grids
+//    too large for the full matrix. Only instances whose locations are all endpoints can be evaluated on it.
+class DistanceTable{
+public:
+    DistanceTable() = default;
+    // distances is the row-major cells.size() x cells.size() table
+    DistanceTable(size_t nCells, const std::vector<uint32_t> &cells, std::vector<int32_t> distances);
+
+    static DistanceTable load(const std::filesystem::path &path);
+    // writes the .npz endpoint table form
+    void saveEndpointTable(const std::filesystem::path &path) const;
+
+    // throws std::out_of_range if a cell is not in the table
+    [[nodiscard]] int64_t at(int64_t fromCell, int64_t toCell) const;
+    [[nodiscard]] int64_t operator()(int64_t fromCell, int64_t toCell) const {
+        return distances[static_cast<size_t>(cellToRow[fromCell]) * nTabled + cellToRow[toCell]];
+    }
+
+    [[nodiscard]] bool contains(int64_t cell) const;
+    // cells of the grid the table was built for
+    [[nodiscard]] size_t getNCells() const;
+private:
+    std::vector<int32_t> cellToRow;
+    size_t nTabled = 0;
+    std::vector<int32_t> distances;
+};
+
+#endif //CMAPD_DISTANCETABLE_HPP
@@ -0,0 +1,72 @@
+#ifndef CMAPD_INSTANCEARCHIVE_HPP
+#define CMAPD_INSTANCEARCHIVE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+#include "InstanceFile.hpp"
+#include "typeDefs.hpp"
+
+// All the instances of one (agents, tasks) configuration in a single file (<instancesDir>.cmpa):
+//   "CMPA" | version | records | index | footer
+// records are binary instance files (see InstanceFile.hpp) stored back to back, the index has one
+// (id: u32, size: u32, offset: u64) entry per record sorted by id and the footer is (index offset: u64,
+// nRecords: u32, "CMPE"). Appending rewrites only the index and the footer.
+namespace instance_archive {
+    static constexpr char magic[4] = {'C', 'M', 'P', 'A'};
+    static constexpr char footerMagic[4] = {'C', 'M', 'P', 'E'};
+    static constexpr uint32_t version = 1;
+    static constexpr char extension[] = ".cmpa";
+
+    struct IndexEntry{
+        uint32_t id;
+        uint32_t size;
+        uint64_t offset;
+    };
+}
+
+// Memory mapped archive with random access by instance id.
+class InstanceArchive{
+public:
+    explicit InstanceArchive(const std::filesystem::path &archivePath);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool contains(uint32_t id) const;
+    // ids of the stored instances, ascending
+    [[nodiscard]] std::vector<uint32_t> getIds() const;
+
+    // throws std::out_of_range if there is no such instance; the view is valid as long as the archive
+    [[nodiscard]] InstanceFileView get(uint32_t id) const;
+private:
+    const std::filesystem::path archivePath;
+    const std::unique_ptr<MappedFile> file;
+    std::vector<instance_archive::IndexEntry> index;
+
+    [[nodiscard]] const instance_archive::IndexEntry* find(uint32_t id) const;
+};
+
+// Appends instances to an archive, creating it if needed. The index is written by close() or by the destructor,
+// an id that is already in the archive is replaced.
+class InstanceArchiveWriter{
+public:
+    explicit InstanceArchiveWriter(const std::filesystem::path &archivePath);
+    ~InstanceArchiveWriter();
+
+    InstanceArchiveWriter(const InstanceArchiveWriter&) = delete;
+    InstanceArchiveWriter& operator=(const InstanceArchiveWriter&) = delete;
+
+    // first id that is not in the archive yet
+    [[nodiscard]] uint32_t nextId() const;
+
+    void add(uint32_t id, size_t nRows, size_t nCols, const CoordVector &agents, const TaskVector &tasks);
+    void close();
+private:
+    std::fstream stream;
+    std::map<uint32_t, instance_archive::IndexEntry> index;
+    uint64_t endOfRecords = 0;
+};
+
+#endif //CMAPD_INSTANCEARCHIVE_HPP
@@ -0,0 +1,75 @@
+#ifndef CMAPD_INSTANCEFILE_HPP
+#define CMAPD_INSTANCEFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "typeDefs.hpp"
+
+// Binary instance file (<id>.inst), replacing the .agents/.tasks text pair. Native byte order, 4 byte words:
+//   "CMPI" | version | nRows | nCols | nAgents | nTasks | agents[nAgents] | (pickup, delivery)[nTasks]
+// where every location is the cell index row * nCols + col.
+namespace instance_file {
+    static constexpr char magic[4] = {'C', 'M', 'P', 'I'};
+    static constexpr uint32_t version = 1;
+    static constexpr char extension[] = ".inst";
+
+    bool isBinary(const std::filesystem::path &filePath);
+
+    // the words of an instance file
+    std::vector<uint32_t> encode(size_t nRows, size_t nCols, const CoordVector &agents, const TaskVector &tasks);
+
+    void write(const std::filesystem::path &filePath, size_t nRows, size_t nCols, const CoordVector &agents,
+               const TaskVector &tasks);
+}
+
+// Read-only memory mapping of a whole file.
+class MappedFile{
+public:
+    explicit MappedFile(const std::filesystem::path &filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const void* data() const;
+    [[nodiscard]] size_t size() const;
+private:
+    const void* mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef WIN32
+    std::vector<uint32_t> buffer;
+#endif
+};
+
+// Read-only view of a binary instance. The accessors point straight into the mapped file (or into the
+// memory of the archive the record belongs to), nothing is parsed or copied.
+class InstanceFileView{
+public:
+    explicit InstanceFileView(const std::filesystem::path &filePath);
+    // view of a record owned by someone else, which must outlive the view
+    InstanceFileView(const void* data, size_t size, const std::string &name);
+
+    [[nodiscard]] uint32_t getNRows() const;
+    [[nodiscard]] uint32_t getNCols() const;
+    [[nodiscard]] uint32_t getNAgents() const;
+    [[nodiscard]] uint32_t getNTasks() const;
+
+    // nAgents cell indices
+    [[nodiscard]] const uint32_t* agents() const;
+    // nTasks (pickup, delivery) cell index pairs, flattened
+    [[nodiscard]] const uint32_t* tasks() const;
+private:
+    static constexpr size_t headerWords = 6;
+
+    std::unique_ptr<MappedFile> file;
+    const uint32_t* words;
+    size_t size;
+
+    void validate(const std::string &name) const;
+};
+
+#endif //CMAPD_INSTANCEFILE_HPP
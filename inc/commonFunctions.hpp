@@ -4,6 +4,8 @@
 #include <filesystem>
 
 std::filesystem::path getInstancesDir(int nAgents, int nTasks, const std::filesystem::path &instancesRoot);
+// single-file alternative to getInstancesDir, see InstanceArchive.hpp
+std::filesystem::path getArchivePath(int nAgents, int nTasks, const std::filesystem::path &instancesRoot);
 std::filesystem::path
 getFilePath(int nAgents, int nTasks, int instanceId, const std::filesystem::path& instancesRoot, std::string_view extension,
             std::string_view methodFolder = "");
@@ -0,0 +1,33 @@
+#ifndef CMAPD_ASSIGNMENTCACHE_HPP
+#define CMAPD_ASSIGNMENTCACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include "typeDefs.hpp"
+
+// Task assignments persisted next to the instances, so that PBS experiments on the same instances do not solve
+// the same routing problem again. A cache file holds the assignments of one instance, one text record per key
+// (a hash of the instance and of the solver parameters, see OrtoolsEnv::assignmentKey):
+//   key <16 hex digits> <solve time in seconds>
+//   <nAgents>
+//   <nWaypoints>,<cell>,<cell>,...     one line per agent
+namespace assignment_cache {
+    static constexpr char extension[] = "assignment";
+
+    // the solve time is the one of the run that stored the assignment, so that a hit can report it
+    struct Record{
+        TASolution assignment;
+        double solveTime = 0;
+    };
+
+    // empty if the file or the key is missing, or the record is malformed
+    std::optional<Record> load(const std::filesystem::path &cachePath, uint64_t key);
+
+    // replaces the record of key; the file is read, merged and rewritten through a temporary file unique to the
+    // calling thread and a rename, under a <cachePath>.lock file lock so that concurrent evaluations of the same
+    // instances do not drop each other's records. Returns false if it cannot be written
+    bool store(const std::filesystem::path &cachePath, uint64_t key, const Record &record);
+}
+
+#endif //CMAPD_ASSIGNMENTCACHE_HPP
@@ -0,0 +1,35 @@
+#ifndef CMAPD_ASSIGNMENTPROTOCOL_HPP
+#define CMAPD_ASSIGNMENTPROTOCOL_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "typeDefs.hpp"
+#include "instances_evaluation/BaseEnv.hpp"
+
+// JSON bodies of the remote assignment service (RemoteAssigner, assignment_server). One POST to target solves a
+// batch of instances with the same capacity:
+//   request:  {"capacity":3,"instances":[{"n_rows":21,"n_cols":35,"agents":[cell,...],"tasks":[[pickup,delivery],...],
+//              "distances":[[...],...]},...]}
+//   response: {"assignments":[[[cell,...],...],...]}, one TASolution per instance, [] if it has none
+//   error:    {"error":"<message>"} with a 4xx or 5xx status
+// The distances are the reduced matrix of the instance, so the service needs neither the grid nor the full matrix.
+namespace assignment_protocol {
+    static constexpr char target[] = "/assign";
+
+    struct Request{
+        int capacity = 0;
+        std::vector<ReducedInstance> instances;
+    };
+
+    std::string writeRequest(const Request &request);
+    // throw std::invalid_argument on malformed bodies
+    Request readRequest(std::string_view body);
+
+    std::string writeResponse(const std::vector<TASolution> &assignments);
+    std::vector<TASolution> readResponse(std::string_view body);
+
+    std::string writeError(const std::string &message);
+}
+
+#endif //CMAPD_ASSIGNMENTPROTOCOL_HPP
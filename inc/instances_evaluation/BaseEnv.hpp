@@ -9,6 +9,8 @@
 #include <numeric>
 #include <filesystem>
 #include "typeDefs.hpp"
+#include "InstanceFile.hpp"
+#include "DistanceTable.hpp"
 #include "cnpy.h"
 #include <vector>
 #include <string_view>
@@ -19,11 +21,29 @@
 #include <random>
 #include <forward_list>
 
+// what a task assignment needs of an instance: the agent and task cells and the distances between them,
+// rows in the order agents, (pickup, delivery) of every task, then the dummy end row
+struct ReducedInstance{
+    size_t nRows = 0;
+    size_t nCols = 0;
+    CompressedCoordVector agents;
+    CompressedTasksVector tasks;
+    CompressedDistanceMatrix distanceMatrix;
+};
+
+// weight of the makespan against the total distance in every assignment objective: the global span cost coefficient
+// of the OR-Tools models and the makespan factor of the insertion heuristics
+static constexpr int64_t makespanWeight = 100;
+
 class BaseEnv{
 public:
     static int64_t from2Dto1D(int64_t x, int64_t y, size_t nCols);
 
     [[nodiscard]] std::vector<bool> getGrid(const std::filesystem::path& mapPath) const;
+    static std::vector<bool> loadGrid(const std::filesystem::path& mapPath, size_t nRows, size_t nCols);
+
+    // full (non reduced) matrix, can be loaded once and shared by every env built on the same grid
+    static DistanceTable loadDistanceMatrix(const std::filesystem::path &distanceMatrixPath);
 
     size_t getNRows() const;
 
@@ -31,9 +51,18 @@ public:
 
     int getNAgents() const;
     int getNTasks() const;
+
+    [[nodiscard]] ReducedInstance getReducedInstance() const;
 protected:
+    // agentsFilePath and taskFilePath may be .agents/.tasks text files or both the same binary .inst file
     BaseEnv(const std::filesystem::path &agentsFilePath, const std::filesystem::path &taskFilePath,
             const std::filesystem::path &distanceMatrixPath);
+    BaseEnv(const std::filesystem::path &agentsFilePath, const std::filesystem::path &taskFilePath,
+            const DistanceTable &fullDistanceMatrix);
+    // instance already in memory, e.g. a record of an InstanceArchive
+    BaseEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix);
+    // instance already reduced, e.g. received by an assignment server
+    explicit BaseEnv(ReducedInstance instance);
 
     const CompressedCoordVector agents;
     const CompressedTasksVector tasks;
@@ -47,12 +76,13 @@ protected:
 private:
     static CompressedCoordVector extractRobotPositions(const std::filesystem::path &agentsFilePath, size_t &nRows, size_t &nCols);
     static CompressedTasksVector extractTasks(const std::filesystem::path &taskFilePath, size_t nCols);
+    static CompressedCoordVector agentsFromView(const InstanceFileView &view);
+    static CompressedTasksVector tasksFromView(const InstanceFileView &view);
 
     static CompressedDistanceMatrix loadReducedDistanceMatrix(const std::filesystem::path &distanceMatrixPath, const CompressedCoordVector &agents,
                                                               const CompressedTasksVector &tasks);
-    static CompressedDistanceMatrix loadDistanceMatrix(const std::filesystem::path &distanceMatrixPath);
     static CompressedDistanceMatrix reduceMatrix(const CompressedCoordVector &agents, const CompressedTasksVector &tasks,
-                                                 CompressedDistanceMatrix && distanceMatrix);
+                                                 const DistanceTable &distanceMatrix);
 };
 
 #endif //CMAPD_BASEENV_HPP
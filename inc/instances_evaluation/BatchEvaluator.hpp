@@ -0,0 +1,135 @@
+#ifndef CMAPD_BATCHEVALUATOR_HPP
+#define CMAPD_BATCHEVALUATOR_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "typeDefs.hpp"
+#include "DistanceTable.hpp"
+#include "HeuristicTable.h"
+#include "InstanceArchive.hpp"
+#include "instances_evaluation/BaseEnv.hpp"
+#include "instances_evaluation/OrtoolsSettings.hpp"
+#include "instances_evaluation/RemoteAssigner.hpp"
+#include "instances_evaluation/ThreadBudget.hpp"
+#include "parameters.hpp"
+#include "PBS.h"
+
+// for a binary instance file agents and tasks are the same path, for a record of an instance archive both are
+// the archive path and archiveId is the instance id
+struct InstanceFiles{
+    std::filesystem::path agents;
+    std::filesystem::path tasks;
+    int64_t archiveId = -1;
+
+    // instance id, used to name per-instance outputs
+    [[nodiscard]] std::string name() const;
+};
+
+// ORTOOLS: OrtoolsEnv, INSERTION: InsertionEnv, REMOTE: an assignment service through RemoteAssigner
+enum class TaskAssigner { ORTOOLS, INSERTION, REMOTE };
+
+struct EvaluationSettings{
+    int capacity = 3;
+    TaskAssigner assigner = TaskAssigner::ORTOOLS;
+    high_level_search hlSearch = HL_DFS;
+    conflict_selection conflictRule = NEWEST;
+    anytime_objective anytime = ANYTIME_OFF;
+    double pbsTimeLimit = 7200;
+    // wall-clock budget of the whole assignment + PBS pipeline of one instance
+    double instanceTimeLimit = std::numeric_limits<double>::infinity();
+    // read and write assignments in the per-instance cache files, see AssignmentCache.hpp
+    bool cacheAssignments = false;
+    OrtoolsSettings ortools;
+    // the extra OR-Tools workers of an assignment take their tokens from it, nullptr: they are not limited
+    ThreadBudget *threadBudget = nullptr;
+    // REMOTE: the service and how the concurrent assignments are batched
+    std::string remoteHost{cuoptHost};
+    std::string remotePort{cuoptPort};
+    size_t remoteBatchSize = 16;
+    std::chrono::milliseconds remoteLinger{5};
+    // a batch that is not answered in time fails its instances, the instance time limit if it is shorter
+    std::chrono::milliseconds remoteTimeout{std::chrono::minutes{10}};
+};
+
+struct EvaluationResult{
+    InstanceFiles instance;
+    int nAgents = 0;
+    int nTasks = 0;
+    double time = 0;
+    // on a cache hit: the solve time of the run that stored the assignment
+    double assignmentTime = 0;
+    bool assignmentCached = false;
+    double pathFindingTime = 0;
+    bool solutionFound = false;
+    int makespan = -1;
+    int sumOfCosts = -1;
+    uint64_t hlExpanded = 0;
+    uint64_t llExpanded = 0;
+};
+
+// output of the assignment stage, input of the path finding stage
+struct AssignedInstance{
+    EvaluationResult result;
+    TASolution assignment;
+};
+
+// Keeps the grid, the full distance matrix and the BFS heuristics of one map resident, so that
+// many instances on that map can be evaluated in the same process.
+class BatchEvaluator{
+public:
+    using SolvedCallback = std::function<void(const InstanceFiles&, const PBS&)>;
+
+    BatchEvaluator(const std::filesystem::path &gridPath, const std::filesystem::path &distanceMatrixPath,
+                   EvaluationSettings settings);
+
+    // task assignment followed by PBS; onSolved runs while the PBS paths are still available
+    EvaluationResult evaluate(const InstanceFiles &instance, const SolvedCallback &onSolved = nullptr) const;
+
+    // the two stages of evaluate, they can run on different threads
+    AssignedInstance assign(const InstanceFiles &instance) const;
+    EvaluationResult findPaths(AssignedInstance assigned, const SolvedCallback &onSolved = nullptr) const;
+
+    // <id>.inst files and <id>.agents / <id>.tasks pairs of a getInstancesDir directory, ordered by id
+    static std::vector<InstanceFiles> listInstances(const std::filesystem::path &instancesDir);
+    // every record of an instance archive, ordered by id
+    static std::vector<InstanceFiles> listArchive(const std::filesystem::path &archivePath);
+    // one "agents_file tasks_file" pair or one binary instance file per line, relative paths are relative to the manifest
+    static std::vector<InstanceFiles> readManifest(const std::filesystem::path &manifestPath);
+
+    static void writeHeader(std::ostream &os);
+    static void writeResult(std::ostream &os, const EvaluationResult &result);
+
+private:
+    const EvaluationSettings settings;
+    const DistanceTable distanceMatrix;
+    size_t nRows = 0;
+    size_t nCols = 0;
+    std::vector<bool> grid;
+    const std::shared_ptr<HeuristicTable> heuristics;
+    // REMOTE only
+    const std::unique_ptr<RemoteAssigner> remoteAssigner;
+
+    // archives stay mapped for the lifetime of the evaluator
+    mutable std::mutex archivesMutex;
+    mutable std::map<std::filesystem::path, std::shared_ptr<const InstanceArchive>> archives;
+
+    std::shared_ptr<const InstanceArchive> getArchive(const std::filesystem::path &archivePath) const;
+    // the assignment environment (OrtoolsEnv or InsertionEnv) of an instance
+    template<typename Env>
+    Env loadEnv(const InstanceFiles &instance) const;
+    void checkGridSize(const BaseEnv &env, const InstanceFiles &instance) const;
+
+    // getFilePath(nAgents, nTasks, id, <instances root>, "assignment", OrtoolsEnv::methodString) for instances named
+    // by their id, <instance dir>/ta_ortools/<name>.assignment otherwise
+    static std::filesystem::path getAssignmentCachePath(const InstanceFiles &instance, int nAgents, int nTasks);
+};
+
+#endif //CMAPD_BATCHEVALUATOR_HPP
@@ -0,0 +1,57 @@
+#ifndef CMAPD_BOUNDEDQUEUE_HPP
+#define CMAPD_BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Multi-producer multi-consumer FIFO with a fixed capacity: producers block while it is full, consumers block
+// while it is empty. Once closed, pop drains the remaining items and then returns nullopt.
+template<typename T>
+class BoundedQueue{
+public:
+    explicit BoundedQueue(size_t capacity) : capacity{capacity > 0 ? capacity : 1} {}
+
+    void push(T item){
+        {
+            std::unique_lock lock{mutex};
+            notFull.wait(lock, [this](){ return items.size() < capacity; });
+            items.push_back(std::move(item));
+        }
+        notEmpty.notify_one();
+    }
+
+    std::optional<T> pop(){
+        std::optional<T> item;
+        {
+            std::unique_lock lock{mutex};
+            notEmpty.wait(lock, [this](){ return !items.empty() || closed; });
+            if (items.empty()){
+                return std::nullopt;
+            }
+            item.emplace(std::move(items.front()));
+            items.pop_front();
+        }
+        notFull.notify_one();
+        return item;
+    }
+
+    // no more push calls will follow
+    void close(){
+        {
+            std::lock_guard lock{mutex};
+            closed = true;
+        }
+        notEmpty.notify_all();
+    }
+private:
+    const size_t capacity;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif //CMAPD_BOUNDEDQUEUE_HPP
@@ -0,0 +1,229 @@
+#ifndef CMAPD_INSERTION_HPP
+#define CMAPD_INSERTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "instances_evaluation/BaseEnv.hpp"
+
+// Insertion kernel of the native assigners (InsertionEnv, RollingAssigner): cheapest insertion of a pickup and
+// delivery task in a route, regret-2 insertion of many tasks and a relocate local search, all minimizing the makespan
+// first and the total distance second. The routes stay in the caller's representation: the callbacks
+//   bestInsertion(const Route&, int agent, size_t task) -> Insertion
+//   insert(Route&, int agent, size_t task, const Insertion&)      keeps Route::length up to date
+//   remove(Route&, int agent, size_t task)                        keeps Route::length up to date
+// work on the routes and on copies of them.
+namespace insertion {
+    // cheapest way to insert a task in a route: pickup after position pickupAfter, delivery after deliveryAfter
+    // (positions of the route before the insertion, 0 is its start)
+    struct Insertion{
+        int64_t delta = -1;
+        int pickupAfter = 0;
+        int deliveryAfter = 0;
+
+        [[nodiscard]] bool feasible() const { return delta >= 0; }
+    };
+
+    // what bestInsertion needs of a route: the cell (or node) at every position, 0 is the start, and the tasks on
+    // board after it
+    struct Positions{
+        std::vector<int64_t> cells;
+        std::vector<int> load;
+    };
+
+    // the pickup goes after a position >= firstPosition (the stops before it are locked), the load never exceeds
+    // capacity; distance(from, to) is the distance between two cells of positions
+    template<typename Distance>
+    Insertion bestInsertion(const Positions &positions, int64_t pickup, int64_t delivery, int capacity,
+                            int firstPosition, const Distance &distance){
+        const auto& cells = positions.cells;
+        const auto& load = positions.load;
+        const int nPositions = static_cast<int>(cells.size()) - 1;
+
+        Insertion best;
+        for (int p = std::clamp(firstPosition, 0, nPositions) ; p <= nPositions ; ++p){
+            if (load[p] >= capacity){
+                continue;
+            }
+            // delivery right after the pickup
+            int64_t delta = distance(cells[p], pickup) + distance(pickup, delivery);
+            if (p < nPositions){
+                delta += distance(delivery, cells[p + 1]) - distance(cells[p], cells[p + 1]);
+            }
+            if (!best.feasible() || delta < best.delta){
+                best = {delta, p, p};
+            }
+            if (p == nPositions){
+                break;
+            }
+
+            // the task stays on board from p + 1 to q
+            const int64_t pickupDelta = distance(cells[p], pickup) + distance(pickup, cells[p + 1]) -
+                distance(cells[p], cells[p + 1]);
+            for (int q = p + 1 ; q <= nPositions && load[q] < capacity ; ++q){
+                delta = pickupDelta + distance(cells[q], delivery);
+                if (q < nPositions){
+                    delta += distance(delivery, cells[q + 1]) - distance(cells[q], cells[q + 1]);
+                }
+                if (delta < best.delta){
+                    best = {delta, p, q};
+                }
+            }
+        }
+        return best;
+    }
+
+    // the stops of a route, without its start
+    template<typename Stop>
+    void insert(std::vector<Stop> &stops, const Insertion &insertion, Stop pickup, Stop delivery){
+        // the delivery goes in first, so that the pickup position is still valid
+        stops.insert(stops.begin() + insertion.deliveryAfter, std::move(delivery));
+        stops.insert(stops.begin() + insertion.pickupAfter, std::move(pickup));
+    }
+
+    template<typename Route>
+    std::pair<int64_t, int64_t> objective(const std::vector<Route> &routes){
+        std::pair<int64_t, int64_t> value{0, 0};
+        for (const auto& route : routes){
+            value.first = std::max(value.first, route.length);
+            value.second += route.length;
+        }
+        return value;
+    }
+
+    // regret-2 insertion of tasks in routes, by makespanWeight * makespan + delta: the task that loses the most by
+    // not getting its best route goes first. Returns the tasks that no route can take
+    template<typename Route, typename BestInsertion, typename Insert>
+    std::vector<size_t> regretInsertion(std::vector<Route> &routes, const std::vector<size_t> &tasks,
+                                        const BestInsertion &bestInsertion, const Insert &insert){
+        constexpr int64_t infinity = std::numeric_limits<int64_t>::max();
+        const int nAgents = static_cast<int>(routes.size());
+
+        // cheapest insertion of every unassigned task in every route, only the changed route is recomputed
+        std::vector<std::vector<Insertion>> insertions(tasks.size(), std::vector<Insertion>(nAgents));
+        for (size_t i = 0 ; i < tasks.size() ; ++i){
+            for (int agent = 0 ; agent < nAgents ; ++agent){
+                insertions[i][agent] = bestInsertion(routes[agent], agent, tasks[i]);
+            }
+        }
+
+        std::vector<size_t> unassigned(tasks.size());
+        for (size_t i = 0 ; i < tasks.size() ; ++i){
+            unassigned[i] = i;
+        }
+
+        int64_t makespan = objective(routes).first;
+        while (!unassigned.empty()){
+            size_t chosen = 0;
+            int chosenAgent = -1;
+            int64_t chosenRegret = -1, chosenCost = infinity;
+
+            for (size_t i = 0 ; i < unassigned.size() ; ++i){
+                int64_t bestCost = infinity, secondCost = infinity;
+                int bestAgent = -1;
+                for (int agent = 0 ; agent < nAgents ; ++agent){
+                    const auto& insertion = insertions[unassigned[i]][agent];
+                    if (!insertion.feasible()){
+                        continue;
+                    }
+                    const int64_t cost = makespanWeight * std::max(makespan, routes[agent].length + insertion.delta) +
+                        insertion.delta;
+                    if (cost < bestCost){
+                        secondCost = bestCost;
+                        bestCost = cost;
+                        bestAgent = agent;
+                    }
+                    else if (cost < secondCost){
+                        secondCost = cost;
+                    }
+                }
+
+                const int64_t regret = secondCost == infinity ? infinity : secondCost - bestCost;
+                if (bestAgent >= 0 && (regret > chosenRegret || (regret == chosenRegret && bestCost < chosenCost))){
+                    chosen = i;
+                    chosenAgent = bestAgent;
+                    chosenRegret = regret;
+                    chosenCost = bestCost;
+                }
+            }
+            if (chosenAgent < 0){
+                break;
+            }
+
+            const size_t index = unassigned[chosen];
+            insert(routes[chosenAgent], chosenAgent, tasks[index], insertions[index][chosenAgent]);
+            makespan = std::max(makespan, routes[chosenAgent].length);
+            unassigned.erase(unassigned.begin() + static_cast<std::ptrdiff_t>(chosen));
+
+            for (size_t other : unassigned){
+                insertions[other][chosenAgent] = bestInsertion(routes[chosenAgent], chosenAgent, tasks[other]);
+            }
+        }
+
+        std::vector<size_t> left;
+        left.reserve(unassigned.size());
+        for (size_t index : unassigned){
+            left.push_back(tasks[index]);
+        }
+        return left;
+    }
+
+    // moves a task off a longest route to its best insertion while that lowers (makespan, total distance), at most
+    // maxMoves times; movableTasks(const Route&, int agent) lists the tasks of a route that may move
+    template<typename Route, typename MovableTasks, typename BestInsertion, typename Insert, typename Remove>
+    void relocate(std::vector<Route> &routes, int maxMoves, const MovableTasks &movableTasks,
+                  const BestInsertion &bestInsertion, const Insert &insert, const Remove &remove){
+        const int nAgents = static_cast<int>(routes.size());
+
+        for (int move = 0 ; move < maxMoves ; ++move){
+            const int longest = static_cast<int>(std::max_element(routes.begin(), routes.end(),
+                [](const Route &a, const Route &b){ return a.length < b.length; }) - routes.begin());
+
+            auto best = objective(routes);
+            size_t bestTask = 0;
+            int bestAgent = -1;
+            Insertion bestMove;
+
+            for (size_t task : movableTasks(routes[longest], longest)){
+                Route shortened = routes[longest];
+                remove(shortened, longest, task);
+
+                for (int agent = 0 ; agent < nAgents ; ++agent){
+                    const Route &target = agent == longest ? shortened : routes[agent];
+                    const auto insertion = bestInsertion(target, agent, task);
+                    if (!insertion.feasible()){
+                        continue;
+                    }
+
+                    // lengths after the move: the target grows by delta, the longest route loses the task
+                    std::pair<int64_t, int64_t> value{0, 0};
+                    for (int other = 0 ; other < nAgents ; ++other){
+                        int64_t length = other == longest ? shortened.length : routes[other].length;
+                        if (other == agent){
+                            length += insertion.delta;
+                        }
+                        value.first = std::max(value.first, length);
+                        value.second += length;
+                    }
+                    if (value < best){
+                        best = value;
+                        bestTask = task;
+                        bestAgent = agent;
+                        bestMove = insertion;
+                    }
+                }
+            }
+
+            if (bestAgent < 0){
+                break;
+            }
+            remove(routes[longest], longest, bestTask);
+            insert(routes[bestAgent], bestAgent, bestTask, bestMove);
+        }
+    }
+}
+
+#endif //CMAPD_INSERTION_HPP
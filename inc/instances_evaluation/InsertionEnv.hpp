@@ -0,0 +1,40 @@
+#ifndef CMAPD_INSERTIONENV_HPP
+#define CMAPD_INSERTIONENV_HPP
+
+#include <filesystem>
+#include <vector>
+#include "typeDefs.hpp"
+#include "instances_evaluation/BaseEnv.hpp"
+#include "instances_evaluation/Insertion.hpp"
+
+// Native task assignment on the reduced distance matrix: regret-2 insertion of whole tasks (pickup, then
+// delivery on the same route, never more than capacity tasks on board) followed by a relocate local search,
+// see Insertion.hpp.
+// Like the OR-Tools model, it minimizes the makespan first and the total distance second; it takes milliseconds,
+// not seconds, but gives no optimality guarantee.
+class InsertionEnv : public BaseEnv{
+public:
+    static constexpr char methodString[] = "ta_insertion";
+
+    InsertionEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath, const DistanceTable &fullDistanceMatrix);
+    InsertionEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix);
+    explicit InsertionEnv(ReducedInstance instance);
+
+    // same layout as OrtoolsEnv::solve: one route per agent, its start followed by the visited task endpoints;
+    // empty if capacity < 1 and there are tasks
+    [[nodiscard]] TASolution solve(int capacity, int maxLocalSearchMoves = 1000) const;
+private:
+    // nodes of the reduced matrix: agent a is a, the pickup and the delivery of task i are nAgents + 2i and + 2i + 1
+    struct Route{
+        std::vector<int> nodes;
+        int64_t length = 0;
+    };
+
+    [[nodiscard]] int64_t distance(int from, int to) const;
+    [[nodiscard]] int64_t routeLength(const Route &route, int agent) const;
+    [[nodiscard]] insertion::Insertion bestInsertion(const Route &route, int agent, size_t task, int capacity) const;
+    void insert(Route &route, int agent, size_t task, const insertion::Insertion &insertion) const;
+    void remove(Route &route, int agent, size_t task) const;
+};
+
+#endif //CMAPD_INSERTIONENV_HPP
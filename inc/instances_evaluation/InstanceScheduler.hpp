@@ -0,0 +1,31 @@
+#ifndef CMAPD_INSTANCESCHEDULER_HPP
+#define CMAPD_INSTANCESCHEDULER_HPP
+
+#include <functional>
+#include <vector>
+#include "instances_evaluation/BatchEvaluator.hpp"
+#include "instances_evaluation/ThreadBudget.hpp"
+
+// Runs the (OrtoolsEnv -> Instance -> PBS) pipelines of many instances at the same time. Instances are dealt
+// round-robin to one deque per worker, idle workers steal from the back of the others' deques.
+class InstanceScheduler{
+public:
+    using ResultCallback = std::function<void(const EvaluationResult&)>;
+
+    InstanceScheduler(const BatchEvaluator &evaluator, ThreadBudget &budget);
+
+    // onResult is called exactly once per instance, in the order of instances, never concurrently
+    void run(const std::vector<InstanceFiles> &instances, const ResultCallback &onResult,
+             const BatchEvaluator::SolvedCallback &onSolved = nullptr) const;
+
+    // two-stage variant: assignment workers feed a bounded queue of assigned instances drained by PBS workers,
+    // the thread counts are clamped so that both stages fit in the budget together
+    void runPipelined(const std::vector<InstanceFiles> &instances, unsigned nAssignmentThreads,
+                      unsigned nPathFindingThreads, size_t queueSize, const ResultCallback &onResult,
+                      const BatchEvaluator::SolvedCallback &onSolved = nullptr) const;
+private:
+    const BatchEvaluator &evaluator;
+    ThreadBudget &budget;
+};
+
+#endif //CMAPD_INSTANCESCHEDULER_HPP
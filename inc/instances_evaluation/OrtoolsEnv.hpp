@@ -1,6 +1,7 @@
 #ifndef PBS_CPP_ENV_HPP
 #define PBS_CPP_ENV_HPP
 
+#include <chrono>
 #include <forward_list>
 #include <random>
 #include <utility>
@@ -17,8 +18,19 @@
 #include "cnpy.h"
 #include "typeDefs.hpp"
 #include "instances_evaluation/BaseEnv.hpp"
-
-using TASolution = std::vector<std::vector<int>>;
+#include "instances_evaluation/OrtoolsSettings.hpp"
+#include "instances_evaluation/ThreadBudget.hpp"
+
+// how an assignment was found
+struct AssignmentStats{
+    // seconds from the start of the assignment to its first feasible solution, -1 if there is none
+    double firstSolutionTime = -1;
+    double time = 0;
+    // makespan of the assignment (largest route span of the distance dimension), -1 if there is none
+    int64_t span = -1;
+    int makespanBound = -1;
+    int nSolves = 0;
+};
 
 class OrtoolsEnv : public BaseEnv{
 public:
@@ -29,42 +41,67 @@ public:
     static constexpr char methodString[] = "ta_ortools";
 
     OrtoolsEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath, const std::filesystem::path &distanceMatrixPath);
-    TASolution solve(int capacity, int makespan) const;
-    TASolution solve(int capacity) const;
+    OrtoolsEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath, const DistanceTable &fullDistanceMatrix);
+    OrtoolsEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix);
+    explicit OrtoolsEnv(ReducedInstance instance);
+    // one routing solve with the given makespan bound, or search.workers concurrent ones; stats, if given, are
+    // updated. The extra workers take tokens from budget, if given, and run only as many as it has free.
+    TASolution solve(int capacity, int makespan, const OrtoolsSettings &search, double timeLimit,
+                     AssignmentStats *stats = nullptr, ThreadBudget *budget = nullptr) const;
+    TASolution solve(int capacity, const OrtoolsSettings &search = {}) const;
+    // minimizes the makespan with search.makespanPolicy, gives up (empty solution) once the deadline has passed
+    TASolution solve(int capacity, std::chrono::steady_clock::time_point deadline, const OrtoolsSettings &search = {},
+                     AssignmentStats *stats = nullptr, ThreadBudget *budget = nullptr) const;
 
     [[nodiscard]] Coord2D get2DCoord(size_t globalIndex) const;
+
+    // hash of everything solve(capacity, ...) depends on: the instance, the capacity and the search settings
+    // (but log_search)
+    [[nodiscard]] uint64_t assignmentKey(int capacity, const OrtoolsSettings &search) const;
 private:
     static constexpr char distanceDimensionString[] = "Distance";
     static constexpr char capacityDimensionString[] = "Capacity";
 
-    const CoordToIndexMap coordToIndexMap;
     const std::vector<int64_t> demands;
 
     const RoutingIndexManager manager;
 
-    static CoordToIndexMap buildCoordToIndexMap(
-        const CompressedCoordVector& agents,
-        const CompressedTasksVector& tasks
-    );
-
     static std::vector<int64_t> computeDemands(size_t nAgents, size_t nTasks);
 
     static OrtoolsEnv::RoutingIndexManager buildRoutingIndexManager(int nAgents, int nMatrixRows);
-    static int buildDistanceCallback(RoutingModel &routingModel, const RoutingIndexManager &manager,
-                                     const CompressedDistanceMatrix &distanceMatrix);
-
-    static int buildDemandCallback(RoutingModel &routingModel, const OrtoolsEnv::RoutingIndexManager &manager,
-                                   const std::vector<int64_t> &demands);
+    // matrix and vector backed transits, indexed by node
+    static int buildDistanceCallback(RoutingModel &routingModel, const CompressedDistanceMatrix &distanceMatrix);
 
-    static RoutingSearchParameters addSearchParameters();
+    static int buildDemandCallback(RoutingModel &routingModel, const std::vector<int64_t> &demands);
 
     static void addDistanceDimension(int makespan, RoutingModel &routingModel, int transitCallbackIndex);
 
     static void addCapacityDimension(int capacity, RoutingModel &routingModel, int demandCallbackIndex, size_t nAgents);
 
-    TASolution getSolution(const operations_research::Assignment *pSolution, RoutingModel &routingModel) const;
-
-    void configurePickupAndDeliveries(RoutingModel &routingModel) const;
+    // distance and capacity dimensions, pickups and deliveries
+    void buildModel(RoutingModel &routingModel, const RoutingIndexManager &indexManager, int capacity, int makespan,
+                    const OrtoolsSettings &search) const;
+    // one SolveWithParameters of an already built model, stats, if given, are updated
+    const operations_research::Assignment* solveModel(RoutingModel &routingModel, const OrtoolsSettings &search,
+                                                      double timeLimit, AssignmentStats *stats) const;
+
+    // search.workers models solved on their own threads with search.withWorkerConfig(worker), keeps the assignment
+    // with the smallest span
+    TASolution solvePortfolio(int capacity, int makespan, const OrtoolsSettings &search, double timeLimit,
+                              AssignmentStats *stats, ThreadBudget *budget) const;
+
+    TASolution solveIncreasing(int capacity, std::chrono::steady_clock::time_point deadline,
+                               const OrtoolsSettings &search, AssignmentStats *stats, ThreadBudget *budget) const;
+    // SPAN_COST and TIGHTENING
+    TASolution solveSpanCost(int capacity, std::chrono::steady_clock::time_point deadline,
+                             const OrtoolsSettings &search, AssignmentStats *stats, ThreadBudget *budget) const;
+
+    TASolution getSolution(const operations_research::Assignment *pSolution, RoutingModel &routingModel,
+                           const RoutingIndexManager &indexManager) const;
+    static int64_t getSpan(const operations_research::Assignment *pSolution, const RoutingModel &routingModel);
+
+    void configurePickupAndDeliveries(RoutingModel &routingModel, const RoutingIndexManager &indexManager,
+                                      RoutingModel::PickupAndDeliveryPolicy policy) const;
 };
 
 
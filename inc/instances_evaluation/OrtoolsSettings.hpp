@@ -0,0 +1,71 @@
+#ifndef CMAPD_ORTOOLSSETTINGS_HPP
+#define CMAPD_ORTOOLSSETTINGS_HPP
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include "ortools/constraint_solver/routing.h"
+#include "ortools/constraint_solver/routing_enums.pb.h"
+#include "ortools/constraint_solver/routing_parameters.h"
+#include "parameters.hpp"
+
+// how OrtoolsEnv::solve(capacity, ...) minimizes the makespan:
+// INCREASING builds and solves a model for every makespan bound from 20 up to the first feasible one,
+// SPAN_COST solves a single model with a horizon every route fits in and lets the span cost lower the makespan,
+// TIGHTENING is SPAN_COST followed by solves of a new model per bound, each bounded below the best span so far
+enum class MakespanPolicy { INCREASING, SPAN_COST, TIGHTENING };
+
+// Runtime OR-Tools search configuration, mapped to RoutingSearchParameters by toSearchParameters.
+// The strategy defaults are still the FIRST_SOLUTION_STRATEGY / LOCAL_SEARCH values chosen at configure time.
+struct OrtoolsSettings{
+    using FirstSolutionStrategy = operations_research::FirstSolutionStrategy;
+    using LocalSearchMetaheuristic = operations_research::LocalSearchMetaheuristic;
+
+    FirstSolutionStrategy::Value firstSolutionStrategy = firstSolutionAlg;
+    LocalSearchMetaheuristic::Value localSearchMetaheuristic = localSearchAlg;
+    // seconds, of every routing solve
+    double timeLimit = 30;
+    // 0: no limit
+    int64_t solutionLimit = 0;
+    // seconds of every LNS neighbourhood, 0: OR-Tools default
+    double lnsTimeLimit = 0;
+    bool logSearch = false;
+    MakespanPolicy makespanPolicy = MakespanPolicy::INCREASING;
+    // order of the tasks loaded on a vehicle at the same time
+    operations_research::RoutingModel::PickupAndDeliveryPolicy pickupDeliveryPolicy =
+        operations_research::RoutingModel::PICKUP_AND_DELIVERY_NO_ORDER;
+    // concurrent routing solves of every model, each with a different configuration (see withWorkerConfig);
+    // the best assignment is kept
+    unsigned workers = 1;
+
+    // option names (also the command line flags) and their help
+    static constexpr std::array<std::pair<const char*, const char*>, 9> options{{
+        {"first_solution_strategy", "OR-Tools first solution strategy, e.g. PARALLEL_CHEAPEST_INSERTION"},
+        {"local_search_metaheuristic", "OR-Tools local search metaheuristic, e.g. GUIDED_LOCAL_SEARCH"},
+        {"ortools_time_limit", "time limit in seconds of every OR-Tools solve"},
+        {"solution_limit", "stop an OR-Tools solve after this many solutions (0 = no limit)"},
+        {"lns_time_limit", "time limit in seconds of every LNS neighbourhood (0 = OR-Tools default)"},
+        {"log_search", "log the OR-Tools search (true, false)"},
+        {"makespan_policy", "makespan minimization: increasing, span_cost, tightening"},
+        {"pickup_delivery_policy", "delivery order of the loaded tasks: any, lifo, fifo"},
+        {"ortools_workers", "concurrent, differently configured OR-Tools solves of every model, the best is kept"}
+    }};
+
+    // throws std::invalid_argument on unknown names or values
+    void setOption(const std::string &name, const std::string &value);
+    // "name = value" lines of the options above, '#' starts a comment
+    void loadFile(const std::filesystem::path &parametersPath);
+
+    [[nodiscard]] operations_research::RoutingSearchParameters toSearchParameters(double solveTimeLimit) const;
+    // "<strategy>/<metaheuristic>"
+    [[nodiscard]] std::string describe() const;
+    // configuration of the worker-th concurrent solve: worker 0 is this one, the others go through a fixed
+    // portfolio of first solution strategies and metaheuristics
+    [[nodiscard]] OrtoolsSettings withWorkerConfig(unsigned worker) const;
+    // the makespan_policy value
+    [[nodiscard]] const char* makespanPolicyName() const;
+};
+
+#endif //CMAPD_ORTOOLSSETTINGS_HPP
@@ -0,0 +1,61 @@
+#ifndef CMAPD_REMOTEASSIGNER_HPP
+#define CMAPD_REMOTEASSIGNER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "typeDefs.hpp"
+#include "instances_evaluation/BaseEnv.hpp"
+
+// Client of a remote assignment service (see AssignmentProtocol.hpp). assign() may be called from many threads:
+// a sender thread groups the pending instances into batches of up to batchSize, waiting at most linger for a batch
+// to fill, and posts every batch on the same keep-alive HTTP connection. A batch that is not answered within timeout
+// (connection, request and response) fails.
+class RemoteAssigner{
+public:
+    RemoteAssigner(std::string host, std::string port, size_t batchSize = 16,
+                   std::chrono::milliseconds linger = std::chrono::milliseconds{5},
+                   std::chrono::milliseconds timeout = std::chrono::minutes{10});
+    ~RemoteAssigner();
+
+    RemoteAssigner(const RemoteAssigner&) = delete;
+    RemoteAssigner& operator=(const RemoteAssigner&) = delete;
+
+    // blocks until the batch of the instance is solved; throws std::runtime_error if the service fails or times out
+    TASolution assign(ReducedInstance instance, int capacity);
+private:
+    struct Pending{
+        ReducedInstance instance;
+        int capacity;
+        std::promise<TASolution> assignment;
+    };
+    class Connection;
+
+    const size_t batchSize;
+    const std::chrono::milliseconds linger;
+    std::unique_ptr<Connection> connection;
+
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<Pending> pending;
+    bool stopping = false;
+    std::thread sender;
+
+    void sendBatches();
+};
+
+// Instance loader for the remote backend, the assignment itself runs on the service.
+class RemoteEnv : public BaseEnv{
+public:
+    RemoteEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath, const DistanceTable &fullDistanceMatrix);
+    RemoteEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix);
+
+    [[nodiscard]] TASolution solve(int capacity, RemoteAssigner &assigner) const;
+};
+
+#endif //CMAPD_REMOTEASSIGNER_HPP
@@ -0,0 +1,112 @@
+#ifndef CMAPD_ROLLINGASSIGNER_HPP
+#define CMAPD_ROLLINGASSIGNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "typeDefs.hpp"
+#include "DistanceTable.hpp"
+#include "instances_evaluation/Insertion.hpp"
+#include "instances_evaluation/OrtoolsSettings.hpp"
+
+struct RollingSettings{
+    // stops at the head of every route that an update never moves: the agent is already on its way to them
+    int lockedStops = 1;
+    // waiting tasks re-inserted by an update besides the new ones, those picked up first in their routes;
+    // the other tasks keep their agent and their order
+    size_t windowTasks = 32;
+    // relocate moves of the window tasks after their insertion
+    int maxLocalSearchMoves = 100;
+    // then re-solve the window with OR-Tools: the plan is the initial assignment, the locked stops are applied as
+    // route locks and the tasks out of the window may only be reordered on their agent
+    bool useOrtools = false;
+    OrtoolsSettings search;
+    // seconds of the OR-Tools re-solve
+    double timeLimit = 0.05;
+};
+
+// A route changed by an update: the route in the TASolution layout (the current cell of the agent, then the cells
+// of its stops) and the task of every stop.
+struct RouteDelta{
+    int agent = 0;
+    std::vector<int> route;
+    std::vector<size_t> stopTasks;
+};
+
+// Rolling horizon task assignment. The routes of the agents are kept while they are executed (advance), the tasks
+// that arrive in between (addTasks) are inserted by the next update, which also re-optimizes a window of the plan and
+// returns the routes it changed; an update costs milliseconds instead of the assignment of every open task.
+// Not thread safe.
+class RollingAssigner{
+public:
+    // throws std::invalid_argument if capacity < 1 or an agent cell is not in the distance table, which must
+    // outlive the assigner
+    RollingAssigner(const DistanceTable &distances, const CompressedCoordVector &agents, int capacity,
+                    RollingSettings settings = {});
+
+    // ids of the new tasks, in order; they are assigned by the next update.
+    // throws std::invalid_argument if a cell is not in the distance table
+    std::vector<size_t> addTasks(const CompressedTasksVector &newTasks);
+    // the agent has reached the first nStops stops of its route and is now at the last of them
+    void advance(int agent, size_t nStops);
+    // routes changed since the previous update
+    std::vector<RouteDelta> update();
+
+    [[nodiscard]] TASolution getSolution() const;
+    // the longest remaining route
+    [[nodiscard]] int64_t getMakespan() const;
+    // assigned or waiting for the next update, not delivered yet
+    [[nodiscard]] size_t getNOpenTasks() const;
+private:
+    struct Task{
+        int64_t pickup;
+        int64_t delivery;
+        bool onBoard = false;
+    };
+
+    struct Stop{
+        size_t task;
+        bool pickup;
+
+        bool operator==(const Stop &other) const { return task == other.task && pickup == other.pickup; }
+    };
+
+    struct Route{
+        int64_t cell;
+        // tasks picked up and not delivered yet
+        int onBoard = 0;
+        std::vector<Stop> stops;
+        int64_t length = 0;
+    };
+
+    const DistanceTable &distances;
+    const int capacity;
+    const RollingSettings settings;
+
+    std::unordered_map<size_t, Task> tasks;
+    size_t nextTaskId = 0;
+    std::vector<size_t> arrived;
+    std::vector<Route> routes;
+    // routes of the previous update, for the deltas
+    std::vector<std::vector<Stop>> published;
+
+    [[nodiscard]] int64_t stopCell(const Stop &stop) const;
+    [[nodiscard]] int64_t routeLength(const Route &route) const;
+
+    // the pickup goes after the locked stops
+    [[nodiscard]] insertion::Insertion bestInsertion(const Route &route, size_t task) const;
+    void insert(Route &route, size_t task, const insertion::Insertion &insertion) const;
+    void remove(Route &route, size_t task) const;
+
+    // regret-2 insertion of the tasks in the plan, see Insertion.hpp
+    void insertTasks(std::vector<Route> &plan, const std::vector<size_t> &newTasks) const;
+    // moves window tasks off a longest route while that lowers the objective
+    void relocate(std::vector<Route> &plan, const std::vector<size_t> &window) const;
+    // the new tasks and the windowTasks waiting tasks picked up first
+    [[nodiscard]] std::vector<size_t> selectWindow(const std::vector<Route> &plan) const;
+    // false if OR-Tools found nothing better than plan
+    bool solveWindowOrtools(std::vector<Route> &plan, const std::vector<size_t> &window) const;
+};
+
+#endif //CMAPD_ROLLINGASSIGNER_HPP
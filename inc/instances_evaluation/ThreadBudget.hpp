@@ -0,0 +1,28 @@
+#ifndef CMAPD_THREADBUDGET_HPP
+#define CMAPD_THREADBUDGET_HPP
+
+#include <condition_variable>
+#include <mutex>
+
+// Process-wide pool of thread tokens: every thread doing solver work (an instance pipeline, a solver's own
+// workers) holds one, so that concurrent pipelines never oversubscribe the machine.
+class ThreadBudget{
+public:
+    // 0 means one token per hardware thread
+    explicit ThreadBudget(unsigned nThreads = 0);
+
+    // blocks until at least one token is free, then takes up to wanted tokens
+    unsigned acquire(unsigned wanted);
+    // takes up to wanted tokens without blocking, possibly none
+    unsigned tryAcquire(unsigned wanted);
+    void release(unsigned n);
+
+    [[nodiscard]] unsigned size() const;
+private:
+    const unsigned total;
+    unsigned available;
+    std::mutex mutex;
+    std::condition_variable released;
+};
+
+#endif //CMAPD_THREADBUDGET_HPP
@@ -1,16 +1,20 @@
 #ifndef PBS_CPP_ABSTRACTENV_HPP
 #define PBS_CPP_ABSTRACTENV_HPP
 
+#include <ostream>
 #include <utility>
 #include <vector>
 #include "typeDefs.hpp"
+#include "instances_generation/GridMatrix.hpp"
 
 class BaseEnvGenerator{
 public:
     explicit BaseEnvGenerator() : matrix() {};
-    explicit BaseEnvGenerator(Matrix  matrix) : matrix(std::move(matrix)) {};
+    explicit BaseEnvGenerator(GridMatrix  matrix) : matrix(std::move(matrix)) {};
     void printGrid() const;
-    [[nodiscard]] const Matrix& getMatrix() const;
+    // grid file format, one line per row
+    void writeGrid(std::ostream& os) const;
+    [[nodiscard]] const GridMatrix& getMatrix() const;
 
 protected:
     static constexpr char ENDPOINT = 'G';
@@ -21,7 +25,7 @@ protected:
     unsigned nCols = 0;
     unsigned nRows = 0;
 
-    Matrix matrix;
+    GridMatrix matrix;
 };
 
 #endif //PBS_CPP_ABSTRACTENV_HPP
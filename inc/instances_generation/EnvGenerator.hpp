@@ -12,34 +12,46 @@
 #include "BaseEnvGenerator.hpp"
 #include "typeDefs.hpp"
 
+enum class InstanceFormat { TEXT, BINARY, ARCHIVE };
+
+struct GeneratedInstance{
+    CoordVector agents;
+    TaskVector tasks;
+};
+
 class EnvGenerator : public BaseEnvGenerator{
 public:
     explicit EnvGenerator(const std::string& gridPath);
     [[nodiscard]] const CoordVector& getEndpoints() const;
 
     // maps path, tasks path
-    std::filesystem::path generateEnvs(int nInstances, int nAgents, int nTasks, std::string_view instancesPath);
+    // BINARY writes one <id>.inst per instance, TEXT the <id>.agents/<id>.tasks pair, ARCHIVE appends the instances
+    // to the getArchivePath archive (ids following the ones already there) and returns the archive path.
+    // Instance i only depends on (seed, id), whatever the number of threads.
+    std::filesystem::path generateEnvs(int nInstances, int nAgents, int nTasks, std::string_view instancesPath,
+                                       InstanceFormat format, uint64_t seed, unsigned nThreads = 0);
 
-private:
-    static std::random_device rd;
-    static std::mt19937 g;
+    // indices must be the identity permutation of the endpoints, it is restored before returning
+    [[nodiscard]] GeneratedInstance sampleInstance(uint64_t seed, uint32_t instanceId, int nAgents, int nTasks,
+                                                   std::vector<int> &indices) const;
 
+private:
     unsigned nEndpoints = 0;
     CoordVector endpoints;
 
     void initializeMatrix(std::fstream& data);
     void fillMatrix(std::fstream& data);
 
-    CoordVector agentsCoords;
-    TaskVector tasks;
-
     [[nodiscard]] static std::filesystem::path
     createInstancesDir(int nAgents, int nTasks, std::string_view instancesRoot) ;
 
     void saveMatrix(int instanceIndex, std::string_view path, int nAgents) const;
-    void saveTasksInfo(int instanceIndex, const std::filesystem::path &path) const;
 
-    void saveAgents(int instanceIndex, const std::filesystem::path &path);
+    static uint32_t uniformBelow(std::mt19937 &rng, uint32_t bound);
+
+    static void saveTasksInfo(int instanceIndex, const std::filesystem::path &path, const GeneratedInstance &instance);
+    void saveAgents(int instanceIndex, const std::filesystem::path &path, const GeneratedInstance &instance) const;
+    void saveInstance(int instanceIndex, const std::filesystem::path &path, const GeneratedInstance &instance) const;
 };
 
 #endif //PBS_CPP_ENVGENERATOR_HPP
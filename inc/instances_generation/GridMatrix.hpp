@@ -0,0 +1,30 @@
+#ifndef CMAPD_GRIDMATRIX_HPP
+#define CMAPD_GRIDMATRIX_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Row-major nRows x nCols grid of cell characters in one contiguous buffer.
+class GridMatrix{
+public:
+    GridMatrix() = default;
+    GridMatrix(size_t nRows, size_t nCols, char fill) : nRows{nRows}, nCols{nCols}, cells(nRows * nCols, fill) {}
+
+    char& operator()(size_t row, size_t col) { return cells[row * nCols + col]; }
+    char operator()(size_t row, size_t col) const { return cells[row * nCols + col]; }
+
+    // cell index row * nCols + col
+    char& operator[](size_t index) { return cells[index]; }
+    char operator[](size_t index) const { return cells[index]; }
+
+    [[nodiscard]] size_t getNRows() const { return nRows; }
+    [[nodiscard]] size_t getNCols() const { return nCols; }
+    [[nodiscard]] size_t size() const { return cells.size(); }
+    [[nodiscard]] const char* data() const { return cells.data(); }
+private:
+    size_t nRows = 0;
+    size_t nCols = 0;
+    std::vector<char> cells;
+};
+
+#endif //CMAPD_GRIDMATRIX_HPP
@@ -0,0 +1,42 @@
+#ifndef CMAPD_WAREHOUSEGENERATOR_HPP
+#define CMAPD_WAREHOUSEGENERATOR_HPP
+
+#include <filesystem>
+#include <vector>
+#include "BaseEnvGenerator.hpp"
+#include "DistanceTable.hpp"
+#include "typeDefs.hpp"
+
+// Parameters of a synthetic warehouse, the defaults reproduce data/grid.txt:
+// a border aisle, parkingColumns double endpoint columns on both sides and shelfRows x shelfBlocks shelf blocks,
+// each one a shelfLength long row of shelves with endpoint rows above and below, separated by aisleWidth aisles.
+struct WarehouseLayout{
+    int shelfRows = 5;
+    int shelfBlocks = 2;
+    int shelfLength = 10;
+    int aisleWidth = 1;
+    int parkingColumns = 2;
+    // one shelf side cell every endpointSpacing is an endpoint, the others are floor
+    int endpointSpacing = 1;
+};
+
+class WarehouseGenerator : public BaseEnvGenerator{
+public:
+    explicit WarehouseGenerator(const WarehouseLayout &layout);
+
+    // endpoints in row-major order
+    [[nodiscard]] const CoordVector& getEndpoints() const;
+
+    // BFS from every endpoint, unreachable pairs are -1
+    [[nodiscard]] DistanceTable computeDistanceTable(unsigned nThreads = 0) const;
+
+    // grid.txt, endpoints.txt and distance_table.npz
+    void save(const std::filesystem::path &outputDir, unsigned nThreads = 0) const;
+private:
+    CoordVector endpoints;
+
+    void fillParking(int firstCol, const WarehouseLayout &layout);
+    void fillShelfBlock(int firstRow, int firstCol, const WarehouseLayout &layout);
+};
+
+#endif //CMAPD_WAREHOUSEGENERATOR_HPP
@@ -10,8 +10,6 @@
 #include <utility>
 #include <string>
 
-using Matrix = std::vector<std::vector<char>>;
-
 using Coord2D = std::pair<int64_t, int64_t>;
 
 using CompressedCoordVector = std::vector<int64_t>;
@@ -22,4 +20,6 @@ using CoordToIndexMap = std::unordered_map<int64_t, int64_t>;
 using CoordVector = std::vector<std::pair<int64_t, int64_t>>;
 using TaskVector = std::vector<std::pair<std::pair<int64_t, int64_t>, std::pair<int64_t, int64_t>>>;
 
+using TASolution = std::vector<std::vector<int>>;
+
 #endif //TA_TYPEDEFS_HPP
@@ -1,14 +1,40 @@
 import subprocess
+import struct
 import os
 
-def execute_instance(exe_path: str, agents_file_path: str, tasks_file_path: str):
+def execute_instance(exe_path: str, agents_file_path: str, tasks_file_path: str, paths_file_path: str = None):
     command = [exe_path, '--a', agents_file_path, '--t', tasks_file_path]
+    if paths_file_path is not None:
+        command += ['--paths_out', paths_file_path]
     print(*command, sep=' ')
 
     result = subprocess.run(command, capture_output=True, check=True)
     return result.stdout.decode("UTF-8")
 
-def instance_stats(decoded_output: str):
+def read_paths(paths_file_path: str):
+    """Reads the run-length encoded paths written by PBS::saveRunLengthPaths as lists of cell indices."""
+    with open(paths_file_path, 'rb') as f:
+        data = f.read()
+
+    paths = []
+    if data[:4] == b'PBSP':
+        version, n_rows, n_cols, n_paths = struct.unpack_from('<4I', data, 4)
+        offset = 20
+        for _ in range(n_paths):
+            (n_runs,) = struct.unpack_from('<I', data, offset)
+            runs = struct.unpack_from(f'<{2 * n_runs}I', data, offset + 4)
+            offset += 4 + 8 * n_runs
+            paths.append([loc for loc, count in zip(runs[::2], runs[1::2]) for _ in range(count)])
+    else:
+        lines = data.decode("UTF-8").strip().split('\n')
+        for line in lines[1:]:
+            fields = [int(v) for v in line.split(',')]
+            runs = fields[2:]
+            paths.append([loc for loc, count in zip(runs[::2], runs[1::2]) for _ in range(count)])
+
+    return paths
+
+def instance_stats(decoded_output: str, paths_file_path: str = None):
     lines = decoded_output.strip().split('\n')
     header_line_n = 3
 
@@ -17,7 +43,10 @@ def instance_stats(decoded_output: str):
         splitter(l)[0]: splitter(l)[1] for l in lines[:header_line_n]
     }
 
-    agents_span = {int(l.split('\t')[1])-1 for l in lines[header_line_n+1:]}
+    if paths_file_path is not None:
+        agents_span = [len(p)-1 for p in read_paths(paths_file_path)]
+    else:
+        agents_span = [int(l.split('\t')[1])-1 for l in lines[header_line_n+1:]]
 
     infos["makespan"] = max(agents_span)
     infos["ttt"] = sum(agents_span)
@@ -25,10 +54,13 @@ def instance_stats(decoded_output: str):
     return infos
 
 def all_stats(exe_path: str, instances_root: str):
-    tasks_files = [os.path.join(instances_root, name) for name in filter(lambda fname: os.path.splitext(fname)[-1] == '.tasks', os.listdir(instances_root))]
-    agents_files = [os.path.join(instances_root, name) for name in filter(lambda fname: os.path.splitext(fname)[-1] == '.agents', os.listdir(instances_root))]
-    
-    return [instance_stats(execute_instance(exe_path, af, tf)) for af, tf in zip(agents_files, tasks_files)]
+    files_with_ext = lambda ext: sorted(os.path.join(instances_root, name) for name in filter(lambda fname: os.path.splitext(fname)[-1] == ext, os.listdir(instances_root)))
+    tasks_files = files_with_ext('.tasks')
+    agents_files = files_with_ext('.agents')
+    # binary instance files hold both agents and tasks
+    instance_files = files_with_ext('.inst')
+
+    return [instance_stats(execute_instance(exe_path, af, tf)) for af, tf in zip(agents_files + instance_files, tasks_files + instance_files)]
 
 if __name__ == "__main__":
     stats = all_stats("out/evaluation", "a40_t130")
@@ -0,0 +1,99 @@
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "DistanceTable.hpp"
+#include "cnpy.h"
+
+DistanceTable::DistanceTable(size_t nCells, const std::vector<uint32_t> &cells, std::vector<int32_t> distances) :
+    cellToRow(nCells, -1),
+    nTabled{cells.size()},
+    distances{std::move(distances)}
+{
+    if (this->distances.size() != nTabled * nTabled){
+        throw std::invalid_argument("distance table is not " + std::to_string(nTabled) + "x" + std::to_string(nTabled));
+    }
+    for (size_t row = 0 ; row < cells.size() ; ++row){
+        if (cells[row] >= nCells){
+            throw std::invalid_argument("distance table cell " + std::to_string(cells[row]) + " is out of the grid");
+        }
+        cellToRow[cells[row]] = static_cast<int32_t>(row);
+    }
+}
+
+DistanceTable DistanceTable::load(const std::filesystem::path &path) {
+    if (path.extension() == ".npz"){
+        auto arrays = cnpy::npz_load(path.string());
+        for (const auto* name : {"n_cells", "cells", "distances"}){
+            if (arrays.find(name) == arrays.end()){
+                throw std::runtime_error(path.string() + " has no " + name + " array");
+            }
+        }
+        const auto& cellsArray = arrays["cells"];
+        const auto& distancesArray = arrays["distances"];
+        if (cellsArray.word_size != sizeof(uint32_t) || distancesArray.word_size != sizeof(int32_t)){
+            throw std::runtime_error(path.string() + ": cells must be uint32 and distances int32");
+        }
+
+        const auto* cells = cellsArray.data<uint32_t>();
+        const auto* distances = distancesArray.data<int32_t>();
+        return {
+            static_cast<size_t>(arrays["n_cells"].data<uint64_t>()[0]),
+            {cells, cells + cellsArray.num_vals},
+            {distances, distances + distancesArray.num_vals}
+        };
+    }
+
+    const cnpy::NpyArray distanceMatrixObj = cnpy::npy_load(path.string());
+    if (distanceMatrixObj.shape.size() != 4 || distanceMatrixObj.word_size != sizeof(double)){
+        throw std::runtime_error(path.string() + " is not a (rows, cols, rows, cols) matrix of doubles");
+    }
+
+    const size_t startCoordsSize = distanceMatrixObj.shape[0] * distanceMatrixObj.shape[1];
+    const size_t endCoordsSize = distanceMatrixObj.shape[2] * distanceMatrixObj.shape[3];
+    if (startCoordsSize != endCoordsSize){
+        throw std::runtime_error(path.string() + " is not a square distance matrix");
+    }
+
+    // distance matrix is considered double
+    const auto* data = distanceMatrixObj.data<double>();
+    std::vector<int32_t> distances(startCoordsSize * endCoordsSize);
+    for (size_t i = 0 ; i < distances.size() ; ++i){
+        distances[i] = static_cast<int32_t>(data[i]);
+    }
+
+    std::vector<uint32_t> cells(startCoordsSize);
+    std::iota(cells.begin(), cells.end(), 0);
+
+    return {startCoordsSize, cells, std::move(distances)};
+}
+
+void DistanceTable::saveEndpointTable(const std::filesystem::path &path) const {
+    std::vector<uint32_t> cells(nTabled);
+    for (size_t cell = 0 ; cell < cellToRow.size() ; ++cell){
+        if (cellToRow[cell] >= 0){
+            cells[cellToRow[cell]] = static_cast<uint32_t>(cell);
+        }
+    }
+    const uint64_t nCells = cellToRow.size();
+
+    cnpy::npz_save(path.string(), "n_cells", &nCells, {1}, "w");
+    cnpy::npz_save(path.string(), "cells", cells.data(), {nTabled}, "a");
+    cnpy::npz_save(path.string(), "distances", distances.data(), {nTabled, nTabled}, "a");
+}
+
+int64_t DistanceTable::at(int64_t fromCell, int64_t toCell) const {
+    if (!contains(fromCell) || !contains(toCell)){
+        throw std::out_of_range(
+            "no distance between cells " + std::to_string(fromCell) + " and " + std::to_string(toCell) + " in the table"
+        );
+    }
+    return (*this)(fromCell, toCell);
+}
+
+bool DistanceTable::contains(int64_t cell) const {
+    return cell >= 0 && static_cast<size_t>(cell) < cellToRow.size() && cellToRow[cell] >= 0;
+}
+
+size_t DistanceTable::getNCells() const {
+    return cellToRow.size();
+}
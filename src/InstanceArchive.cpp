@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "InstanceArchive.hpp"
+
+namespace {
+    using instance_archive::IndexEntry;
+
+    constexpr size_t headerSize = 8;
+    constexpr size_t entrySize = 16;
+    constexpr size_t footerSize = 16;
+
+    struct Footer{
+        uint64_t indexOffset;
+        uint32_t nRecords;
+    };
+
+    Footer parseFooter(const char* bytes, const std::string &name){
+        if (std::memcmp(bytes + 12, instance_archive::footerMagic, sizeof(instance_archive::footerMagic)) != 0){
+            throw std::runtime_error(name + " has no valid index, the archive was not closed");
+        }
+        Footer footer{};
+        std::memcpy(&footer.indexOffset, bytes, sizeof(footer.indexOffset));
+        std::memcpy(&footer.nRecords, bytes + 8, sizeof(footer.nRecords));
+        return footer;
+    }
+
+    void checkHeader(const char* bytes, const std::string &name){
+        uint32_t version;
+        std::memcpy(&version, bytes + 4, sizeof(version));
+        if (std::memcmp(bytes, instance_archive::magic, sizeof(instance_archive::magic)) != 0){
+            throw std::runtime_error(name + " is not an instance archive");
+        }
+        if (version != instance_archive::version){
+            throw std::runtime_error("unsupported version of instance archive " + name);
+        }
+    }
+
+    std::vector<IndexEntry> parseIndex(const char* bytes, uint32_t nRecords){
+        std::vector<IndexEntry> index(nRecords);
+        for (auto& entry : index){
+            std::memcpy(&entry.id, bytes, sizeof(entry.id));
+            std::memcpy(&entry.size, bytes + 4, sizeof(entry.size));
+            std::memcpy(&entry.offset, bytes + 8, sizeof(entry.offset));
+            bytes += entrySize;
+        }
+        return index;
+    }
+
+    std::string recordName(const std::filesystem::path &archivePath, uint32_t id){
+        return archivePath.string() + "#" + std::to_string(id);
+    }
+}
+
+InstanceArchive::InstanceArchive(const std::filesystem::path &archivePath) :
+    archivePath{archivePath},
+    file{std::make_unique<MappedFile>(archivePath)}
+{
+    const auto* bytes = static_cast<const char*>(file->data());
+    const auto name = archivePath.string();
+
+    if (file->size() < headerSize + footerSize){
+        throw std::runtime_error(name + " is not an instance archive");
+    }
+    checkHeader(bytes, name);
+
+    const auto footer = parseFooter(bytes + file->size() - footerSize, name);
+    if (footer.indexOffset < headerSize || footer.indexOffset + footer.nRecords * entrySize + footerSize != file->size()){
+        throw std::runtime_error("corrupted index in instance archive " + name);
+    }
+
+    index = parseIndex(bytes + footer.indexOffset, footer.nRecords);
+    for (const auto& entry : index){
+        if (entry.offset < headerSize || entry.offset + entry.size > footer.indexOffset || entry.offset % sizeof(uint32_t) != 0){
+            throw std::runtime_error("corrupted record " + recordName(archivePath, entry.id));
+        }
+    }
+}
+
+size_t InstanceArchive::size() const {
+    return index.size();
+}
+
+bool InstanceArchive::contains(uint32_t id) const {
+    return find(id) != nullptr;
+}
+
+const instance_archive::IndexEntry *InstanceArchive::find(uint32_t id) const {
+    auto it = std::lower_bound(index.cbegin(), index.cend(), id, [](const IndexEntry& entry, uint32_t id){
+        return entry.id < id;
+    });
+    return (it == index.cend() || it->id != id) ? nullptr : &*it;
+}
+
+std::vector<uint32_t> InstanceArchive::getIds() const {
+    std::vector<uint32_t> ids;
+    ids.reserve(index.size());
+    for (const auto& entry : index){
+        ids.push_back(entry.id);
+    }
+    return ids;
+}
+
+InstanceFileView InstanceArchive::get(uint32_t id) const {
+    const auto* entry = find(id);
+    if (entry == nullptr){
+        throw std::out_of_range("no instance " + recordName(archivePath, id));
+    }
+
+    return {static_cast<const char*>(file->data()) + entry->offset, entry->size, recordName(archivePath, id)};
+}
+
+InstanceArchiveWriter::InstanceArchiveWriter(const std::filesystem::path &archivePath) {
+    namespace fs = std::filesystem;
+    const auto name = archivePath.string();
+
+    if (!fs::exists(archivePath) || fs::file_size(archivePath) == 0){
+        stream.open(archivePath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!stream.is_open()){
+            throw std::runtime_error("cannot create instance archive " + name);
+        }
+        uint32_t header[2];
+        std::memcpy(&header[0], instance_archive::magic, sizeof(instance_archive::magic));
+        header[1] = instance_archive::version;
+        stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+        endOfRecords = headerSize;
+        return;
+    }
+
+    const auto fileSize = fs::file_size(archivePath);
+    stream.open(archivePath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!stream.is_open() || fileSize < headerSize + footerSize){
+        throw std::runtime_error("cannot append to instance archive " + name);
+    }
+
+    char header[headerSize];
+    stream.read(header, headerSize);
+    checkHeader(header, name);
+
+    char footerBytes[footerSize];
+    stream.seekg(static_cast<std::streamoff>(fileSize - footerSize));
+    stream.read(footerBytes, footerSize);
+    const auto footer = parseFooter(footerBytes, name);
+
+    std::vector<char> indexBytes(footer.nRecords * entrySize);
+    stream.seekg(static_cast<std::streamoff>(footer.indexOffset));
+    stream.read(indexBytes.data(), static_cast<std::streamsize>(indexBytes.size()));
+    if (!stream){
+        throw std::runtime_error("corrupted index in instance archive " + name);
+    }
+
+    for (const auto& entry : parseIndex(indexBytes.data(), footer.nRecords)){
+        index[entry.id] = entry;
+    }
+    // new records overwrite the old index, which is written again on close
+    endOfRecords = footer.indexOffset;
+}
+
+InstanceArchiveWriter::~InstanceArchiveWriter() {
+    try{
+        close();
+    }
+    catch (...){
+        // the archive is left without a valid index, InstanceArchive reports it
+    }
+}
+
+uint32_t InstanceArchiveWriter::nextId() const {
+    return index.empty() ? 0 : index.crbegin()->first + 1;
+}
+
+void InstanceArchiveWriter::add(uint32_t id, size_t nRows, size_t nCols, const CoordVector &agents, const TaskVector &tasks) {
+    const auto words = instance_file::encode(nRows, nCols, agents, tasks);
+    const auto size = static_cast<uint32_t>(words.size() * sizeof(uint32_t));
+
+    stream.seekp(static_cast<std::streamoff>(endOfRecords));
+    stream.write(reinterpret_cast<const char*>(words.data()), size);
+    index[id] = {id, size, endOfRecords};
+    endOfRecords += size;
+}
+
+void InstanceArchiveWriter::close() {
+    if (!stream.is_open()){
+        return;
+    }
+
+    std::vector<char> tail((index.size() * entrySize) + footerSize);
+    auto* bytes = tail.data();
+    for (const auto& [id, entry] : index){
+        std::memcpy(bytes, &entry.id, sizeof(entry.id));
+        std::memcpy(bytes + 4, &entry.size, sizeof(entry.size));
+        std::memcpy(bytes + 8, &entry.offset, sizeof(entry.offset));
+        bytes += entrySize;
+    }
+    const auto nRecords = static_cast<uint32_t>(index.size());
+    std::memcpy(bytes, &endOfRecords, sizeof(endOfRecords));
+    std::memcpy(bytes + 8, &nRecords, sizeof(nRecords));
+    std::memcpy(bytes + 12, instance_archive::footerMagic, sizeof(instance_archive::footerMagic));
+
+    stream.seekp(static_cast<std::streamoff>(endOfRecords));
+    stream.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+    stream.close();
+    if (stream.fail()){
+        throw std::runtime_error("cannot write the index of an instance archive");
+    }
+}
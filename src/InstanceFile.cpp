@@ -0,0 +1,148 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "InstanceFile.hpp"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool instance_file::isBinary(const std::filesystem::path &filePath) {
+    std::ifstream file{filePath, std::ios::binary};
+    char header[sizeof(magic)] = {};
+    return file.read(header, sizeof(header)) && std::memcmp(header, magic, sizeof(magic)) == 0;
+}
+
+std::vector<uint32_t> instance_file::encode(size_t nRows, size_t nCols, const CoordVector &agents, const TaskVector &tasks) {
+    std::vector<uint32_t> words;
+    words.reserve(6 + agents.size() + tasks.size() * 2);
+
+    uint32_t magicWord;
+    std::memcpy(&magicWord, magic, sizeof(magicWord));
+    words.insert(words.end(), {
+        magicWord, version, static_cast<uint32_t>(nRows), static_cast<uint32_t>(nCols),
+        static_cast<uint32_t>(agents.size()), static_cast<uint32_t>(tasks.size())
+    });
+
+    auto toIndex = [nCols](const std::pair<int64_t, int64_t>& coord){
+        return static_cast<uint32_t>(coord.first * static_cast<int64_t>(nCols) + coord.second);
+    };
+
+    for (const auto& agent : agents){
+        words.push_back(toIndex(agent));
+    }
+    for (const auto& [pickup, delivery] : tasks){
+        words.push_back(toIndex(pickup));
+        words.push_back(toIndex(delivery));
+    }
+
+    return words;
+}
+
+void instance_file::write(const std::filesystem::path &filePath, size_t nRows, size_t nCols, const CoordVector &agents,
+                          const TaskVector &tasks) {
+    const auto words = encode(nRows, nCols, agents, tasks);
+
+    std::ofstream file{filePath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()){
+        throw std::runtime_error("cannot write instance file " + filePath.string());
+    }
+    file.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(uint32_t)));
+}
+
+MappedFile::MappedFile(const std::filesystem::path &filePath) {
+#ifdef WIN32
+    std::ifstream file{filePath, std::ios::binary | std::ios::ate};
+    if (!file.is_open()){
+        throw std::runtime_error("cannot open " + filePath.string());
+    }
+    mappingSize = static_cast<size_t>(file.tellg());
+    buffer.resize((mappingSize + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(mappingSize));
+    mapping = buffer.data();
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0){
+        throw std::runtime_error("cannot open " + filePath.string());
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && st.st_size > 0){
+        mappingSize = static_cast<size_t>(st.st_size);
+        void* fileMapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        mapping = (fileMapping == MAP_FAILED) ? nullptr : fileMapping;
+    }
+    close(fd);
+    if (mapping == nullptr){
+        throw std::runtime_error("cannot map " + filePath.string());
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef WIN32
+    munmap(const_cast<void*>(mapping), mappingSize);
+#endif
+}
+
+const void *MappedFile::data() const {
+    return mapping;
+}
+
+size_t MappedFile::size() const {
+    return mappingSize;
+}
+
+InstanceFileView::InstanceFileView(const std::filesystem::path &filePath) :
+    file{std::make_unique<MappedFile>(filePath)},
+    words{static_cast<const uint32_t*>(file->data())},
+    size{file->size()}
+{
+    validate(filePath.string());
+}
+
+InstanceFileView::InstanceFileView(const void *data, size_t size, const std::string &name) :
+    words{static_cast<const uint32_t*>(data)},
+    size{size}
+{
+    validate(name);
+}
+
+void InstanceFileView::validate(const std::string &name) const {
+    if (size < headerWords * sizeof(uint32_t) || std::memcmp(words, instance_file::magic, sizeof(instance_file::magic)) != 0){
+        throw std::runtime_error(name + " is not a binary instance");
+    }
+    if (words[1] != instance_file::version){
+        throw std::runtime_error("unsupported version of instance " + name);
+    }
+    if (size < (headerWords + getNAgents() + static_cast<size_t>(getNTasks()) * 2) * sizeof(uint32_t)){
+        throw std::runtime_error("truncated instance " + name);
+    }
+}
+
+uint32_t InstanceFileView::getNRows() const {
+    return words[2];
+}
+
+uint32_t InstanceFileView::getNCols() const {
+    return words[3];
+}
+
+uint32_t InstanceFileView::getNAgents() const {
+    return words[4];
+}
+
+uint32_t InstanceFileView::getNTasks() const {
+    return words[5];
+}
+
+const uint32_t *InstanceFileView::agents() const {
+    return words + headerWords;
+}
+
+const uint32_t *InstanceFileView::tasks() const {
+    return agents() + getNAgents();
+}
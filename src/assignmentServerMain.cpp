@@ -0,0 +1,200 @@
+#include <boost/program_options.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "instances_evaluation/AssignmentProtocol.hpp"
+#include "instances_evaluation/InsertionEnv.hpp"
+#include "instances_evaluation/OrtoolsEnv.hpp"
+#include "instances_evaluation/OrtoolsSettings.hpp"
+#include "parameters.hpp"
+
+// Local stand-in of the remote assignment service used by evaluation --assigner remote: answers POST /assign
+// (see AssignmentProtocol.hpp) with the native insertion heuristic or with OR-Tools, so that the remote path can be
+// run and tested offline. One thread per connection, the instances of a batch are solved on --threads threads.
+namespace {
+    namespace beast = boost::beast;
+    namespace http = beast::http;
+    using tcp = boost::asio::ip::tcp;
+
+    struct ServerSettings{
+        bool useOrtools = false;
+        OrtoolsSettings ortools;
+        double timeLimit = 0;
+        unsigned nThreads = 1;
+    };
+
+    std::vector<TASolution> solveBatch(assignment_protocol::Request request, const ServerSettings &settings){
+        std::vector<TASolution> assignments(request.instances.size());
+        std::atomic<size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+
+        auto work = [&](){
+            for (size_t i = next++ ; i < request.instances.size() ; i = next++){
+                try{
+                    if (settings.useOrtools){
+                        using Clock = std::chrono::steady_clock;
+                        auto deadline = settings.timeLimit > 0 ? Clock::now() +
+                            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings.timeLimit)) :
+                            Clock::time_point::max();
+                        const OrtoolsEnv env{std::move(request.instances[i])};
+                        assignments[i] = env.solve(request.capacity, deadline, settings.ortools);
+                    }
+                    else{
+                        const InsertionEnv env{std::move(request.instances[i])};
+                        assignments[i] = env.solve(request.capacity);
+                    }
+                }
+                catch (...){
+                    std::lock_guard lock{failureMutex};
+                    failure = std::current_exception();
+                }
+            }
+        };
+
+        const auto nThreads = static_cast<unsigned>(std::min<size_t>(settings.nThreads, request.instances.size()));
+        std::vector<std::thread> threads;
+        for (unsigned t = 1 ; t < nThreads ; ++t){
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& thread : threads){
+            thread.join();
+        }
+        if (failure){
+            std::rethrow_exception(failure);
+        }
+        return assignments;
+    }
+
+    http::response<http::string_body> handle(const http::request<http::string_body> &request,
+                                             const ServerSettings &settings){
+        http::response<http::string_body> response{http::status::ok, request.version()};
+        response.set(http::field::content_type, "application/json");
+        response.keep_alive(request.keep_alive());
+
+        if (request.target() != assignment_protocol::target){
+            response.result(http::status::not_found);
+            response.body() = assignment_protocol::writeError("unknown target " + std::string(request.target()));
+        }
+        else if (request.method() != http::verb::post){
+            response.result(http::status::method_not_allowed);
+            response.body() = assignment_protocol::writeError("use POST");
+        }
+        else{
+            try{
+                response.body() = assignment_protocol::writeResponse(
+                    solveBatch(assignment_protocol::readRequest(request.body()), settings)
+                );
+            }
+            catch (const std::invalid_argument &e){
+                response.result(http::status::bad_request);
+                response.body() = assignment_protocol::writeError(e.what());
+            }
+            catch (const std::exception &e){
+                response.result(http::status::internal_server_error);
+                response.body() = assignment_protocol::writeError(e.what());
+            }
+        }
+
+        response.prepare_payload();
+        return response;
+    }
+
+    void serve(tcp::socket socket, const ServerSettings &settings){
+        beast::error_code error;
+        beast::flat_buffer buffer;
+
+        for (;;){
+            http::request_parser<http::string_body> parser;
+            parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+            http::read(socket, buffer, parser, error);
+            if (error){
+                break;
+            }
+
+            auto response = handle(parser.get(), settings);
+            http::write(socket, response, error);
+            if (error || !response.keep_alive()){
+                break;
+            }
+        }
+        socket.shutdown(tcp::socket::shutdown_send, error);
+    }
+}
+
+int main(int argc, char** argv){
+    namespace po = boost::program_options;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("host", po::value<std::string>()->default_value(std::string{cuoptHost}), "address to listen on")
+        ("port", po::value<std::string>()->default_value(std::string{cuoptPort}), "port to listen on")
+        ("assigner", po::value<std::string>()->default_value("insertion"), "solver of the requests: insertion, ortools")
+        ("threads", po::value<unsigned>()->default_value(0),
+            "threads solving the instances of one request (0 = hardware threads)")
+        ("time_limit", po::value<double>()->default_value(0), "ortools: time limit in seconds per instance (0 = none)")
+        ("ortools_params", po::value<std::string>(),
+            "ortools: file of \"name = value\" OR-Tools options (the flags below), the flags override it");
+
+    for (const auto& [name, help] : OrtoolsSettings::options) {
+        desc.add_options()(name, po::value<std::string>(), help);
+    }
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    po::notify(vm);
+
+    ServerSettings settings;
+    const auto assigner = vm["assigner"].as<std::string>();
+    if (assigner != "ortools" && assigner != "insertion") {
+        std::cerr << "unknown assigner " << assigner << "\n" << desc << '\n';
+        return 1;
+    }
+    settings.useOrtools = assigner == "ortools";
+    settings.timeLimit = vm["time_limit"].as<double>();
+    settings.nThreads = vm["threads"].as<unsigned>();
+    if (settings.nThreads == 0) {
+        settings.nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    if (vm.count("ortools_params")) {
+        settings.ortools.loadFile(vm["ortools_params"].as<std::string>());
+    }
+    for (const auto& [name, help] : OrtoolsSettings::options) {
+        if (vm.count(name)) {
+            settings.ortools.setOption(name, vm[name].as<std::string>());
+        }
+    }
+
+    boost::asio::io_context ioContext;
+    const tcp::endpoint endpoint{
+        boost::asio::ip::make_address(vm["host"].as<std::string>() == "localhost" ? "127.0.0.1" : vm["host"].as<std::string>()),
+        static_cast<unsigned short>(std::stoi(vm["port"].as<std::string>()))
+    };
+    tcp::acceptor acceptor{ioContext, endpoint};
+    std::cout << "listening on " << endpoint << ", solving with " << assigner << std::endl;
+
+    for (;;){
+        tcp::socket socket{ioContext};
+        acceptor.accept(socket);
+        std::thread{serve, std::move(socket), std::cref(settings)}.detach();
+    }
+}
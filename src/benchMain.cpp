@@ -0,0 +1,565 @@
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "commonFunctions.hpp"
+#include "InstanceArchive.hpp"
+#include "instances_evaluation/BatchEvaluator.hpp"
+#include "instances_evaluation/OrtoolsEnv.hpp"
+#include "instances_evaluation/RollingAssigner.hpp"
+#include "instances_generation/EnvGenerator.hpp"
+#include "instances_generation/WarehouseGenerator.hpp"
+#include "Profiler.h"
+
+// End-to-end benchmark: every (agents, tasks, capacity) configuration of a fixed, seeded corpus is evaluated
+// sequentially, one report row per configuration, and optionally compared against a baseline report.
+
+namespace {
+    namespace fs = std::filesystem;
+
+    // times are in seconds, expansions and makespan are summed over the instances of the configuration,
+    // ortools_solve is the mean time of one routing solve
+    const std::vector<std::string> reportColumns{
+        "agents", "tasks", "capacity", "instances", "solved", "wall", "load", "assignment", "ortools_solve",
+        "heuristics", "pbs", "peak_rss_kb", "hl_expanded", "ll_expanded", "makespan"
+    };
+
+    // metrics where a higher value is a regression, time metrics are compared with the time tolerance
+    const std::vector<std::string> timeMetrics{"wall", "load", "assignment", "ortools_solve", "heuristics", "pbs"};
+    const std::vector<std::string> countMetrics{"peak_rss_kb", "hl_expanded", "ll_expanded", "makespan"};
+
+    using ConfigKey = std::tuple<int, int, int>;
+    using Report = std::map<ConfigKey, std::map<std::string, double>>;
+
+    std::vector<std::string> splitList(const std::string &list){
+        std::vector<std::string> values;
+        std::stringstream stream{list};
+        std::string value;
+        while (std::getline(stream, value, ',')){
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    std::vector<int> parseList(const std::string &list){
+        std::vector<int> values;
+        for (const auto& value : splitList(list)){
+            values.push_back(std::stoi(value));
+        }
+        return values;
+    }
+
+    double seconds(const std::string &timerName){
+        return static_cast<double>(Profiler::instance().getTimer(timerName).total_ns.load()) * 1e-9;
+    }
+
+    void resetPeakRss(){
+        // Linux only: writing 5 resets VmHWM, elsewhere the peak stays process-wide
+        std::ofstream clearRefs{"/proc/self/clear_refs"};
+        clearRefs << "5";
+    }
+
+    // peak RSS since the last resetPeakRss, in KiB
+    long peakRss(){
+        std::ifstream status{"/proc/self/status"};
+        std::string line;
+        while (std::getline(status, line)){
+            if (line.rfind("VmHWM:", 0) == 0){
+                return std::stol(line.substr(6));
+            }
+        }
+#ifndef _WIN32
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+#else
+        return 0;
+#endif
+    }
+
+    // the first nInstances records of the (agents, tasks) archive of the corpus, generated if missing
+    std::vector<InstanceFiles> corpusInstances(EnvGenerator &generator, const fs::path &corpusDir, int nAgents, int nTasks,
+                                               int nInstances, uint64_t seed, unsigned nThreads){
+        const auto archivePath = getArchivePath(nAgents, nTasks, corpusDir);
+        const int nRecords = fs::exists(archivePath) ? static_cast<int>(InstanceArchive{archivePath}.size()) : 0;
+        if (nRecords < nInstances){
+            // instance ids only depend on the seed, so a grown corpus keeps its first records
+            generator.generateEnvs(nInstances - nRecords, nAgents, nTasks, corpusDir.string(), InstanceFormat::ARCHIVE,
+                                   seed, nThreads);
+        }
+
+        auto instances = BatchEvaluator::listArchive(archivePath);
+        instances.resize(nInstances);
+        return instances;
+    }
+
+    // one OR-Tools configuration of a strategy sweep
+    struct SweepRow{
+        OrtoolsSettings search;
+        int capacity = 0;
+        int instances = 0;
+        int solved = 0;
+        // sums, over the solved instances for firstSolutionTime and span
+        double firstSolutionTime = 0;
+        double time = 0;
+        double span = 0;
+    };
+
+    // assignment only, every (strategy, metaheuristic) pair on every instance of the corpus
+    std::vector<SweepRow> sweepStrategies(const std::map<std::pair<int, int>, std::vector<InstanceFiles>> &corpus,
+                                          const DistanceTable &distanceTable, const std::vector<int> &capacities,
+                                          const std::vector<std::string> &strategies,
+                                          const std::vector<std::string> &metaheuristics, const OrtoolsSettings &base){
+        std::map<fs::path, std::unique_ptr<InstanceArchive>> archives;
+        std::vector<SweepRow> rows;
+
+        for (int capacity : capacities){
+            for (const auto& strategy : strategies){
+                for (const auto& metaheuristic : metaheuristics){
+                    SweepRow row{base, capacity};
+                    row.search.setOption("first_solution_strategy", strategy);
+                    row.search.setOption("local_search_metaheuristic", metaheuristic);
+
+                    for (const auto& [configuration, instances] : corpus){
+                        for (const auto& instance : instances){
+                            auto& archive = archives[instance.agents];
+                            if (!archive){
+                                archive = std::make_unique<InstanceArchive>(instance.agents);
+                            }
+                            const OrtoolsEnv env(archive->get(static_cast<uint32_t>(instance.archiveId)), distanceTable);
+
+                            AssignmentStats stats;
+                            const auto assignment = env.solve(
+                                capacity, std::chrono::steady_clock::time_point::max(), row.search, &stats
+                            );
+                            ++row.instances;
+                            row.time += stats.time;
+                            if (!assignment.empty()){
+                                ++row.solved;
+                                row.firstSolutionTime += stats.firstSolutionTime;
+                                row.span += static_cast<double>(stats.span);
+                            }
+                        }
+                    }
+
+                    std::cerr << row.search.describe() << "_c" << capacity << "\t" << row.time << "s\t"
+                              << row.solved << "/" << row.instances << " solved\n";
+                    rows.push_back(std::move(row));
+                }
+            }
+        }
+
+        // most solved instances first, then the fastest to a first feasible assignment, then the smallest span
+        auto mean = [](double sum, int n){ return n > 0 ? sum / n : std::numeric_limits<double>::infinity(); };
+        std::stable_sort(rows.begin(), rows.end(), [&mean](const SweepRow &a, const SweepRow &b){
+            return std::make_tuple(a.capacity, -a.solved, mean(a.firstSolutionTime, a.solved), mean(a.span, a.solved)) <
+                std::make_tuple(b.capacity, -b.solved, mean(b.firstSolutionTime, b.solved), mean(b.span, b.solved));
+        });
+        return rows;
+    }
+
+    void writeSweep(std::ostream &os, const std::vector<SweepRow> &rows){
+        os << "rank\tcapacity\tfirst_solution_strategy\tlocal_search_metaheuristic\tinstances\tsolved\t"
+           << "first_feasible\ttime\tspan\n";
+        int rank = 0;
+        for (size_t i = 0 ; i < rows.size() ; ++i){
+            const auto& row = rows[i];
+            rank = (i > 0 && rows[i - 1].capacity == row.capacity) ? rank + 1 : 1;
+            const double solved = std::max(row.solved, 1);
+            os << rank << "\t" << row.capacity << "\t"
+               << OrtoolsSettings::FirstSolutionStrategy::Value_Name(row.search.firstSolutionStrategy) << "\t"
+               << OrtoolsSettings::LocalSearchMetaheuristic::Value_Name(row.search.localSearchMetaheuristic) << "\t"
+               << row.instances << "\t" << row.solved << "\t" << row.firstSolutionTime / solved << "\t"
+               << row.time / std::max(row.instances, 1) << "\t" << row.span / solved << "\n";
+        }
+    }
+
+    // one (capacity, agents, tasks) configuration of a rolling horizon replay
+    struct RollingRow{
+        int capacity = 0;
+        int agents = 0;
+        int tasks = 0;
+        int instances = 0;
+        int updates = 0;
+        // seconds
+        double updateTime = 0;
+        double maxUpdateTime = 0;
+        size_t changedRoutes = 0;
+        // sum over the instances of the longest distance an agent travelled
+        int64_t makespan = 0;
+    };
+
+    // the tasks of every instance arrive arrivals at a time, in file order; between two updates every agent with
+    // stops reaches the next one
+    std::vector<RollingRow> rollingReplay(const std::map<std::pair<int, int>, std::vector<InstanceFiles>> &corpus,
+                                          const DistanceTable &distanceTable, const std::vector<int> &capacities,
+                                          size_t arrivals, const RollingSettings &settings){
+        std::map<fs::path, std::unique_ptr<InstanceArchive>> archives;
+        std::vector<RollingRow> rows;
+
+        for (int capacity : capacities){
+            for (const auto& [configuration, instances] : corpus){
+                RollingRow row{capacity, configuration.first, configuration.second};
+
+                for (const auto& instance : instances){
+                    auto& archive = archives[instance.agents];
+                    if (!archive){
+                        archive = std::make_unique<InstanceArchive>(instance.agents);
+                    }
+                    const auto view = archive->get(static_cast<uint32_t>(instance.archiveId));
+                    const CompressedCoordVector agents(view.agents(), view.agents() + view.getNAgents());
+                    CompressedTasksVector tasks;
+                    for (uint32_t task = 0 ; task < view.getNTasks() ; ++task){
+                        tasks.emplace_back(view.tasks()[2 * task], view.tasks()[2 * task + 1]);
+                    }
+
+                    RollingAssigner assigner(distanceTable, agents, capacity, settings);
+                    std::vector<int64_t> travelled(agents.size(), 0);
+                    for (size_t next = 0 ; next < tasks.size() || assigner.getNOpenTasks() > 0 ;){
+                        const size_t end = std::min(tasks.size(), next + arrivals);
+                        assigner.addTasks({tasks.begin() + static_cast<std::ptrdiff_t>(next),
+                                           tasks.begin() + static_cast<std::ptrdiff_t>(end)});
+                        next = end;
+
+                        auto start = std::chrono::steady_clock::now();
+                        row.changedRoutes += assigner.update().size();
+                        const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                        ++row.updates;
+                        row.updateTime += time;
+                        row.maxUpdateTime = std::max(row.maxUpdateTime, time);
+
+                        const auto routes = assigner.getSolution();
+                        for (int agent = 0 ; agent < static_cast<int>(routes.size()) ; ++agent){
+                            if (routes[agent].size() > 1){
+                                travelled[agent] += distanceTable(routes[agent][0], routes[agent][1]);
+                                assigner.advance(agent, 1);
+                            }
+                        }
+                    }
+                    ++row.instances;
+                    row.makespan += *std::max_element(travelled.begin(), travelled.end());
+                }
+
+                std::cerr << "rolling_a" << row.agents << "_t" << row.tasks << "_c" << capacity << "\t"
+                          << row.updateTime << "s\t" << row.updates << " updates\n";
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    void writeRolling(std::ostream &os, const std::vector<RollingRow> &rows){
+        os << "agents\ttasks\tcapacity\tinstances\tupdates\tmean_update\tmax_update\tchanged_routes\tmakespan\n";
+        for (const auto& row : rows){
+            const double updates = std::max(row.updates, 1);
+            os << row.agents << "\t" << row.tasks << "\t" << row.capacity << "\t" << row.instances << "\t"
+               << row.updates << "\t" << row.updateTime / updates << "\t" << row.maxUpdateTime << "\t"
+               << static_cast<double>(row.changedRoutes) / updates << "\t" << row.makespan << "\n";
+        }
+    }
+
+    Report readReport(const fs::path &reportPath){
+        std::ifstream reportFile{reportPath};
+        if (!reportFile.is_open()){
+            throw std::runtime_error("cannot read benchmark report " + reportPath.string());
+        }
+
+        std::string line;
+        std::getline(reportFile, line);
+        std::vector<std::string> header;
+        {
+            std::stringstream stream{line};
+            std::string column;
+            while (std::getline(stream, column, '\t')){
+                header.push_back(column);
+            }
+        }
+
+        Report report;
+        while (std::getline(reportFile, line)){
+            if (line.empty()){
+                continue;
+            }
+            std::stringstream stream{line};
+            std::string value;
+            std::map<std::string, double> row;
+            for (size_t i = 0 ; i < header.size() && std::getline(stream, value, '\t') ; ++i){
+                row[header[i]] = std::stod(value);
+            }
+            report[{static_cast<int>(row["agents"]), static_cast<int>(row["tasks"]), static_cast<int>(row["capacity"])}] =
+                std::move(row);
+        }
+        return report;
+    }
+
+    // prints one line per regression, returns their number
+    int compareReports(const Report &baseline, const Report &current, double timeTolerance, double countTolerance,
+                       double minTime){
+        int nRegressions = 0;
+        auto flag = [&nRegressions](const ConfigKey &key, const std::string &metric, double before, double after){
+            std::cout << "REGRESSION\ta" << std::get<0>(key) << "_t" << std::get<1>(key) << "_c" << std::get<2>(key)
+                      << "\t" << metric << "\t" << before << "\t->\t" << after << "\n";
+            ++nRegressions;
+        };
+
+        for (const auto& [key, row] : current){
+            auto baselineRow = baseline.find(key);
+            if (baselineRow == baseline.end()){
+                continue;
+            }
+            const auto& before = baselineRow->second;
+            if (row.at("instances") != before.at("instances")){
+                // sums over different corpora are not comparable
+                std::cerr << "skipping a" << std::get<0>(key) << "_t" << std::get<1>(key) << "_c" << std::get<2>(key)
+                          << ": the baseline has " << before.at("instances") << " instances\n";
+                continue;
+            }
+
+            if (row.at("solved") < before.at("solved")){
+                flag(key, "solved", before.at("solved"), row.at("solved"));
+            }
+            for (const auto& metric : timeMetrics){
+                // baselines written before a metric was added do not have it
+                if (!before.count(metric)){
+                    continue;
+                }
+                const double old = before.at(metric), now = row.at(metric);
+                if (now > minTime && now > old * (1 + timeTolerance)){
+                    flag(key, metric, old, now);
+                }
+            }
+            for (const auto& metric : countMetrics){
+                if (!before.count(metric)){
+                    continue;
+                }
+                const double old = before.at(metric), now = row.at(metric);
+                if (now > old * (1 + countTolerance)){
+                    flag(key, metric, old, now);
+                }
+            }
+        }
+        return nRegressions;
+    }
+}
+
+int main(int argc, char** argv){
+    namespace po = boost::program_options;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message (use absolute paths or paths relative to working directory)")
+        ("map_dir", po::value<std::string>(),
+            "map directory written by generate_instances --warehouse (default: the default warehouse layout, which is "
+            "data/grid.txt, generated under corpus_dir)")
+        ("grid_path", po::value<std::string>(), "path of grid file, overrides map_dir")
+        ("dm_path", po::value<std::string>(), "path of distance matrix (.npy) or endpoint distance table (.npz), overrides map_dir")
+        ("corpus_dir", po::value<std::string>()->default_value("./bench_corpus"),
+            "instance archives of the corpus, generated on first use")
+        ("agents", po::value<std::string>()->default_value("10,20,30"), "comma separated numbers of agents")
+        ("tasks", po::value<std::string>()->default_value("20,50"), "comma separated numbers of tasks")
+        ("capacities", po::value<std::string>()->default_value("1,3"), "comma separated agent capacities")
+        ("assigner", po::value<std::string>()->default_value("ortools"), "task assignment: ortools, insertion")
+        ("n", po::value<int>()->default_value(10), "instances per (agents, tasks) configuration")
+        ("seed", po::value<uint64_t>()->default_value(20240101), "corpus seed")
+        ("pbs_time_limit", po::value<double>()->default_value(60), "PBS time limit in seconds")
+        ("instance_time_limit", po::value<double>(), "time limit in seconds of the assignment + PBS of one instance")
+        ("out", po::value<std::string>()->default_value("bench.tsv"), "report, one tab separated row per configuration")
+        ("baseline", po::value<std::string>(), "compare the report against this one and exit with 2 on regressions")
+        ("time_tolerance", po::value<double>()->default_value(0.2), "allowed relative slowdown of the time metrics")
+        ("count_tolerance", po::value<double>()->default_value(0.05),
+            "allowed relative increase of peak RSS, expansions and makespan")
+        ("min_time", po::value<double>()->default_value(0.05), "time metrics below this many seconds are not compared")
+        ("sweep_strategies", po::value<std::string>(),
+            "strategy sweep: assignment only, rank every pair of these comma separated first solution strategies and "
+            "the --sweep_metaheuristics by solved instances, time to the first feasible assignment and final span")
+        ("sweep_metaheuristics", po::value<std::string>(), "comma separated local search metaheuristics of the sweep")
+        ("rolling_arrivals", po::value<size_t>(),
+            "rolling horizon replay: assignment only, the tasks of every instance arrive this many at a time and the "
+            "agents reach one stop between two updates; reports the update latency (--assigner ortools re-solves the "
+            "window with OR-Tools)")
+        ("rolling_window", po::value<size_t>()->default_value(32), "rolling: waiting tasks re-optimized per update")
+        ("rolling_locked", po::value<int>()->default_value(1), "rolling: stops at the head of a route never moved")
+        ("rolling_time_limit", po::value<double>()->default_value(0.05),
+            "rolling: time limit in seconds of the OR-Tools window re-solve")
+        ("ortools_params", po::value<std::string>(), "file of \"name = value\" OR-Tools options, the flags override it");
+
+    for (const auto& [name, help] : OrtoolsSettings::options) {
+        desc.add_options()(name, po::value<std::string>(), help);
+    }
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    po::notify(vm);
+
+    const auto agentsList = parseList(vm["agents"].as<std::string>());
+    const auto tasksList = parseList(vm["tasks"].as<std::string>());
+    const auto capacities = parseList(vm["capacities"].as<std::string>());
+    const auto assigner = vm["assigner"].as<std::string>();
+    if (assigner != "ortools" && assigner != "insertion") {
+        std::cerr << "unknown assigner " << assigner << "\n" << desc << '\n';
+        return 1;
+    }
+    const int nInstances = vm["n"].as<int>();
+    const uint64_t seed = vm["seed"].as<uint64_t>();
+    const fs::path corpusRoot = vm["corpus_dir"].as<std::string>();
+    const fs::path corpusDir = corpusRoot / ("seed_" + std::to_string(seed));
+
+    fs::path mapDir = vm.count("map_dir") ? fs::path{vm["map_dir"].as<std::string>()} : corpusRoot / "map";
+    if (!vm.count("map_dir") && !fs::exists(mapDir / "distance_table.npz")) {
+        WarehouseGenerator{WarehouseLayout{}}.save(mapDir);
+    }
+    const fs::path gridPath = vm.count("grid_path") ? fs::path{vm["grid_path"].as<std::string>()} : mapDir / "grid.txt";
+    const fs::path distanceMatrixPath = vm.count("dm_path") ? fs::path{vm["dm_path"].as<std::string>()} :
+        mapDir / "distance_table.npz";
+
+    EnvGenerator generator(gridPath.string());
+    std::map<std::pair<int, int>, std::vector<InstanceFiles>> corpus;
+    for (int nAgents : agentsList){
+        for (int nTasks : tasksList){
+            corpus[{nAgents, nTasks}] = corpusInstances(generator, corpusDir, nAgents, nTasks, nInstances, seed, 0);
+        }
+    }
+
+    OrtoolsSettings ortools;
+    if (vm.count("ortools_params")) {
+        ortools.loadFile(vm["ortools_params"].as<std::string>());
+    }
+    for (const auto& [name, help] : OrtoolsSettings::options) {
+        if (vm.count(name)) {
+            ortools.setOption(name, vm[name].as<std::string>());
+        }
+    }
+
+    if (vm.count("sweep_strategies") || vm.count("sweep_metaheuristics")) {
+        const auto strategies = vm.count("sweep_strategies") ? splitList(vm["sweep_strategies"].as<std::string>()) :
+            std::vector{OrtoolsSettings::FirstSolutionStrategy::Value_Name(ortools.firstSolutionStrategy)};
+        const auto metaheuristics = vm.count("sweep_metaheuristics") ?
+            splitList(vm["sweep_metaheuristics"].as<std::string>()) :
+            std::vector{OrtoolsSettings::LocalSearchMetaheuristic::Value_Name(ortools.localSearchMetaheuristic)};
+
+        const auto rows = sweepStrategies(
+            corpus, BaseEnv::loadDistanceMatrix(distanceMatrixPath), capacities, strategies, metaheuristics, ortools
+        );
+        std::ofstream out{vm["out"].as<std::string>()};
+        writeSweep(out, rows);
+        writeSweep(std::cout, rows);
+        return 0;
+    }
+
+    if (vm.count("rolling_arrivals")) {
+        RollingSettings settings;
+        settings.windowTasks = vm["rolling_window"].as<size_t>();
+        settings.lockedStops = vm["rolling_locked"].as<int>();
+        settings.useOrtools = assigner == "ortools";
+        settings.search = ortools;
+        settings.timeLimit = vm["rolling_time_limit"].as<double>();
+
+        const auto rows = rollingReplay(
+            corpus, BaseEnv::loadDistanceMatrix(distanceMatrixPath), capacities,
+            std::max<size_t>(vm["rolling_arrivals"].as<size_t>(), 1), settings
+        );
+        std::ofstream out{vm["out"].as<std::string>()};
+        writeRolling(out, rows);
+        writeRolling(std::cout, rows);
+        return 0;
+    }
+
+    Profiler::instance().setEnabled(true);
+    Report report;
+
+    for (int capacity : capacities){
+        EvaluationSettings settings;
+        settings.capacity = capacity;
+        // the assignment phase is measured, never read it from the cache
+        settings.cacheAssignments = false;
+        settings.ortools = ortools;
+        settings.assigner = assigner == "insertion" ? TaskAssigner::INSERTION : TaskAssigner::ORTOOLS;
+        settings.pbsTimeLimit = vm["pbs_time_limit"].as<double>();
+        if (vm.count("instance_time_limit")) {
+            settings.instanceTimeLimit = vm["instance_time_limit"].as<double>();
+        }
+
+        const BatchEvaluator evaluator(gridPath, distanceMatrixPath, settings);
+
+        for (const auto& [configuration, instances] : corpus){
+            const auto [nAgents, nTasks] = configuration;
+            Profiler::instance().reset();
+            resetPeakRss();
+
+            auto& row = report[{nAgents, nTasks, capacity}];
+            row["agents"] = nAgents;
+            row["tasks"] = nTasks;
+            row["capacity"] = capacity;
+            row["instances"] = static_cast<double>(instances.size());
+
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& instance : instances){
+                const auto result = evaluator.evaluate(instance);
+                row["solved"] += result.solutionFound;
+                row["hl_expanded"] += static_cast<double>(result.hlExpanded);
+                row["ll_expanded"] += static_cast<double>(result.llExpanded);
+                row["makespan"] += result.solutionFound ? result.makespan : 0;
+            }
+            row["wall"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            row["load"] = seconds("load_instance") + seconds("reduce_matrix");
+            // the probe solves run inside ortools_assignment and are counted twice, as in every earlier report, so
+            // that assignment stays comparable with older baselines; ortools_solve isolates one routing solve
+            row["assignment"] = seconds("ortools_probe") + seconds("ortools_assignment") +
+                seconds("insertion_assignment");
+            const auto nSolves = Profiler::instance().getTimer("ortools_probe").count.load();
+            row["ortools_solve"] = nSolves > 0 ? seconds("ortools_probe") / static_cast<double>(nSolves) : 0;
+            row["heuristics"] = seconds("compute_heuristics");
+            row["pbs"] = seconds("pbs_search");
+            row["peak_rss_kb"] = static_cast<double>(peakRss());
+
+            std::cerr << "a" << nAgents << "_t" << nTasks << "_c" << capacity << "\t" << row["wall"] << "s\t"
+                      << row["solved"] << "/" << instances.size() << " solved\n";
+        }
+    }
+
+    std::ofstream out{vm["out"].as<std::string>()};
+    for (size_t i = 0 ; i < reportColumns.size() ; ++i){
+        out << (i ? "\t" : "") << reportColumns[i];
+    }
+    out << "\n";
+    for (const auto& [key, row] : report){
+        for (size_t i = 0 ; i < reportColumns.size() ; ++i){
+            auto value = row.find(reportColumns[i]);
+            out << (i ? "\t" : "") << (value == row.end() ? 0 : value->second);
+        }
+        out << "\n";
+    }
+    out.close();
+
+    if (vm.count("baseline")) {
+        const int nRegressions = compareReports(
+            readReport(vm["baseline"].as<std::string>()), report, vm["time_tolerance"].as<double>(),
+            vm["count_tolerance"].as<double>(), vm["min_time"].as<double>()
+        );
+        std::cout << "Regressions:\t" << nRegressions << "\n";
+        return nRegressions > 0 ? 2 : 0;
+    }
+
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <array>
 #include <fstream>
 #include "commonFunctions.hpp"
+#include "InstanceArchive.hpp"
 
 namespace fs = std::filesystem;
 
@@ -13,6 +14,10 @@ std::filesystem::path getInstancesDir(int nAgents, int nTasks, const std::filesy
     return instancesRoot / dirId;
 }
 
+std::filesystem::path getArchivePath(int nAgents, int nTasks, const std::filesystem::path &instancesRoot) {
+    return getInstancesDir(nAgents, nTasks, instancesRoot).concat(instance_archive::extension);
+}
+
 std::filesystem::path
 getFilePath(int nAgents, int nTasks, int instanceId, const std::filesystem::path& instancesRoot, std::string_view extension,
             std::string_view methodFolder) {
@@ -2,10 +2,36 @@
 #include <filesystem>
 #include <string>
 #include <chrono>
+#include <fstream>
+#include <sstream>
 
-#include "instances_evaluation/OrtoolsEnv.hpp"
-#include "Instance.h"
+#include "instances_evaluation/BatchEvaluator.hpp"
+#include "instances_evaluation/InstanceScheduler.hpp"
 #include "PBS.h"
+#include "Profiler.h"
+
+namespace {
+    void appendBatchProfile(const std::filesystem::path &profilePath, size_t nInstances, unsigned nThreads, double time){
+        std::ofstream profile{profilePath, std::ios::app};
+        profile << "{\"instances\":" << nInstances << ",\"threads\":" << nThreads << ",\"time\":" << time
+            << ",\"phases\":" << Profiler::instance().toJson() << "}\n";
+    }
+
+    void appendProfile(const std::filesystem::path &profilePath, const EvaluationResult &result){
+        std::ofstream profile{profilePath, std::ios::app};
+        profile << "{\"agents\":" << result.instance.agents << ",\"tasks\":" << result.instance.tasks
+            << ",\"nA\":" << result.nAgents << ",\"nT\":" << result.nTasks
+            << ",\"time\":" << result.time
+            << ",\"solution_found\":" << (result.solutionFound ? "true" : "false")
+            << ",\"makespan\":" << result.makespan
+            << ",\"hl_expanded\":" << result.hlExpanded << ",\"ll_expanded\":" << result.llExpanded
+            << ",\"phases\":" << Profiler::instance().toJson() << "}\n";
+    }
+
+    void savePaths(const PBS &pbs, const std::filesystem::path &pathsOut, bool binary){
+        pbs.saveRunLengthPaths(pathsOut.string(), binary);
+    }
+}
 
 int main(int argc, char** argv){
     namespace po = boost::program_options;
@@ -16,15 +42,62 @@ int main(int argc, char** argv){
 
     auto defaultGridPath = exeDir / "data" / "grid.txt";
     auto defaultDMPath = exeDir / "data" / "distance_matrix.npy";
+#ifdef USE_CO_OPT
+    const std::string defaultAssigner = "remote";
+#else
+    const std::string defaultAssigner = "ortools";
+#endif
 
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help", "produce help message (use absolute paths or paths relative to working directory)")
         ("grid_path", po::value<std::string>()->default_value(defaultGridPath), "instancesPath of grid file")
         ("dm_path", po::value<std::string>()->default_value(defaultDMPath), "instancesPath of distance matrix")
-        ("a", po::value<std::string>()->required(), "Agents file")
-        ("t", po::value<std::string>()->required(), "Tasks file")
-        ("c", po::value<int>()->default_value(3), "Capacity of each Agent");
+        ("a", po::value<std::string>(), "Agents file, or binary instance file")
+        ("t", po::value<std::string>(), "Tasks file (not needed for a binary instance file)")
+        ("instances_dir", po::value<std::string>(), "evaluate every <id>.agents/<id>.tasks pair of this directory")
+        ("archive", po::value<std::string>(), "evaluate every instance of this instance archive (.cmpa)")
+        ("id", po::value<int64_t>(), "evaluate only this instance of --archive")
+        ("manifest", po::value<std::string>(), "evaluate every \"agents_file tasks_file\" pair or instance file listed in this file")
+        ("results_out", po::value<std::string>()->default_value("results.tsv"), "batch mode: results are appended to this file")
+        ("c", po::value<int>()->default_value(3), "Capacity of each Agent")
+        ("assigner", po::value<std::string>()->default_value(defaultAssigner),
+            "task assignment: ortools, insertion (native regret insertion, milliseconds, no OR-Tools options) or "
+            "remote (an assignment service, e.g. assignment_server)")
+        ("remote_host", po::value<std::string>()->default_value(std::string{cuoptHost}), "remote: assignment service host")
+        ("remote_port", po::value<std::string>()->default_value(std::string{cuoptPort}), "remote: assignment service port")
+        ("remote_batch", po::value<size_t>()->default_value(16),
+            "remote: concurrent assignments sent in one request (batch mode, with --threads or --assignment_threads)")
+        ("remote_linger_ms", po::value<int>()->default_value(5), "remote: longest wait for a batch to fill")
+        ("remote_timeout", po::value<double>()->default_value(600),
+            "remote: seconds after which an unanswered batch fails (at most --instance_time_limit)")
+        ("hl_search", po::value<std::string>()->default_value("DFS"), "PBS high-level search (DFS, BEST_COST, BEST_MAKESPAN, LDS)")
+        ("conflict_rule", po::value<std::string>()->default_value("NEWEST"),
+            "PBS conflict selection rule (NEWEST, RANDOM, EARLIEST, CONFLICTS, MCONSTRAINTS, FCONSTRAINTS)")
+        ("anytime", po::value<std::string>()->default_value("off"),
+            "keep improving the PBS solution until the time limit (off, makespan, soc)")
+        ("pbs_time_limit", po::value<double>()->default_value(7200), "PBS time limit in seconds")
+        ("instance_time_limit", po::value<double>(), "time limit in seconds of the assignment + PBS of one instance")
+        ("assignment_cache", po::bool_switch(),
+            "read and write OR-Tools assignments in the <instance dir>/ta_ortools cache, a hit reports the time of "
+            "the run that solved it")
+        ("threads", po::value<unsigned>()->default_value(0),
+            "batch mode: thread budget shared by all the instance pipelines and their OR-Tools workers (0 = hardware threads)")
+        ("assignment_threads", po::value<unsigned>()->default_value(0),
+            "batch mode: run task assignment and path finding as two pipelined stages, with this many assignment threads")
+        ("path_finding_threads", po::value<unsigned>()->default_value(0), "batch mode: number of PBS threads of the pipeline")
+        ("queue_size", po::value<size_t>()->default_value(4), "batch mode: assigned instances waiting for a PBS thread")
+        ("ortools_params", po::value<std::string>(),
+            "file of \"name = value\" OR-Tools options (the flags below), the flags override it")
+        ("paths_out", po::value<std::string>(),
+            "write run-length encoded paths to this file instead of printing them (a directory in batch mode)")
+        ("paths_format", po::value<std::string>()->default_value("binary"), "format of paths_out (binary, csv)")
+        ("profile_out", po::value<std::string>(),
+            "append a JSON record with per-phase wall-clock timings to this file (one record per batch in batch mode)");
+
+    for (const auto& [name, help] : OrtoolsSettings::options) {
+        desc.add_options()(name, po::value<std::string>(), help);
+    }
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -36,44 +109,139 @@ int main(int argc, char** argv){
 
     po::notify(vm);
 
-    const std::filesystem::path tasksFile = vm["t"].as<std::string>();
-    const std::filesystem::path agentsFile = vm["a"].as<std::string>();
+    const bool batch = vm.count("instances_dir") || vm.count("manifest") || (vm.count("archive") && !vm.count("id"));
+    if (!batch && !vm.count("a") && !vm.count("archive")) {
+        std::cerr << "either --a (and --t), --archive or --instances_dir/--manifest are required\n" << desc << '\n';
+        return 1;
+    }
+
+    EvaluationSettings settings;
+    settings.capacity = vm["c"].as<int>();
+    const auto assigner = vm["assigner"].as<std::string>();
+    if (assigner != "ortools" && assigner != "insertion" && assigner != "remote") {
+        std::cerr << "unknown assigner " << assigner << "\n" << desc << '\n';
+        return 1;
+    }
+    settings.assigner = assigner == "insertion" ? TaskAssigner::INSERTION :
+        (assigner == "remote" ? TaskAssigner::REMOTE : TaskAssigner::ORTOOLS);
+    settings.remoteHost = vm["remote_host"].as<std::string>();
+    settings.remotePort = vm["remote_port"].as<std::string>();
+    settings.remoteBatchSize = vm["remote_batch"].as<size_t>();
+    settings.remoteLinger = std::chrono::milliseconds{vm["remote_linger_ms"].as<int>()};
+    settings.remoteTimeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::duration<double>(vm["remote_timeout"].as<double>()));
+    settings.hlSearch = highLevelSearchFromString(vm["hl_search"].as<std::string>());
+    settings.conflictRule = conflictSelectionFromString(vm["conflict_rule"].as<std::string>());
+    settings.anytime = anytimeFromString(vm["anytime"].as<std::string>());
+    settings.pbsTimeLimit = vm["pbs_time_limit"].as<double>();
+    if (vm.count("instance_time_limit")) {
+        settings.instanceTimeLimit = vm["instance_time_limit"].as<double>();
+    }
+
+    settings.cacheAssignments = vm["assignment_cache"].as<bool>();
+    if (vm.count("ortools_params")) {
+        settings.ortools.loadFile(vm["ortools_params"].as<std::string>());
+    }
+    for (const auto& [name, help] : OrtoolsSettings::options) {
+        if (vm.count(name)) {
+            settings.ortools.setOption(name, vm[name].as<std::string>());
+        }
+    }
+
+    const auto pathsFormat = vm["paths_format"].as<std::string>();
+    if (pathsFormat != "binary" && pathsFormat != "csv") {
+        std::cerr << "unknown paths format " << pathsFormat << "\n" << desc << '\n';
+        return 1;
+    }
+    const bool binaryPaths = pathsFormat == "binary";
+
+    Profiler::instance().setEnabled(vm.count("profile_out") > 0);
 
     // Record start time
     auto start = std::chrono::steady_clock::now();
 
-    OrtoolsEnv env(
-            agentsFile,
-            tasksFile,
-            vm["dm_path"].as<std::string>()
-    );
-
-    Instance instance(
-        env.getGrid(vm["grid_path"].as<string>()),
-        env.solve(vm["c"].as<int>()),
-        env.getNRows(),
-        env.getNCols()
-    );
+    // shared by the instance pipelines and the OR-Tools workers of their assignments
+    ThreadBudget budget{vm["threads"].as<unsigned>()};
+    if (batch) {
+        settings.threadBudget = &budget;
+    }
 
-    PBS pbs(instance, true, 0);
+    const BatchEvaluator evaluator(vm["grid_path"].as<std::string>(), vm["dm_path"].as<std::string>(), settings);
+
+    if (batch) {
+        const auto instances = vm.count("archive") ? BatchEvaluator::listArchive(vm["archive"].as<std::string>()) :
+            vm.count("instances_dir") ? BatchEvaluator::listInstances(vm["instances_dir"].as<std::string>()) :
+            BatchEvaluator::readManifest(vm["manifest"].as<std::string>());
+
+        const fs::path resultsPath = vm["results_out"].as<std::string>();
+        const bool newResults = !fs::exists(resultsPath);
+        std::ofstream results{resultsPath, std::ios::app};
+        if (newResults) {
+            BatchEvaluator::writeHeader(results);
+        }
+
+        BatchEvaluator::SolvedCallback onSolved = nullptr;
+        if (vm.count("paths_out")) {
+            const fs::path pathsDir = vm["paths_out"].as<std::string>();
+            fs::create_directories(pathsDir);
+            onSolved = [pathsDir, binaryPaths](const InstanceFiles& instance, const PBS& pbs){
+                savePaths(pbs, pathsDir / (instance.name() + ".paths"), binaryPaths);
+            };
+        }
+
+        const InstanceScheduler scheduler{evaluator, budget};
+        auto writeResult = [&results](const EvaluationResult& result){
+            BatchEvaluator::writeResult(results, result);
+            results.flush();
+        };
+
+        const auto nAssignmentThreads = vm["assignment_threads"].as<unsigned>();
+        const auto nPathFindingThreads = vm["path_finding_threads"].as<unsigned>();
+        if (nAssignmentThreads > 0 || nPathFindingThreads > 0) {
+            scheduler.runPipelined(
+                instances, nAssignmentThreads, nPathFindingThreads, vm["queue_size"].as<size_t>(), writeResult, onSolved
+            );
+        }
+        else {
+            scheduler.run(instances, writeResult, onSolved);
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Time:\t" << elapsed.count() << "\n";
+        std::cout << "Instances:\t" << instances.size() << "\n";
+
+        if (vm.count("profile_out")) {
+            appendBatchProfile(vm["profile_out"].as<std::string>(), instances.size(), budget.size(), elapsed.count());
+        }
+        return 0;
+    }
 
-    srand(0);
-    pbs.solve(7200);
+    std::ostringstream paths;
+    const std::string agentsFile = vm.count("archive") ? vm["archive"].as<std::string>() : vm["a"].as<std::string>();
+    const InstanceFiles instance{
+        agentsFile, vm.count("t") ? vm["t"].as<std::string>() : agentsFile, vm.count("id") ? vm["id"].as<int64_t>() : -1
+    };
+    const auto result = evaluator.evaluate(instance, [&vm, &paths, binaryPaths](const InstanceFiles&, const PBS& pbs){
+        if (vm.count("paths_out")){
+            savePaths(pbs, vm["paths_out"].as<std::string>(), binaryPaths);
+        }
+        else{
+            pbs.writePaths(paths);
+        }
+    });
 
     auto end = std::chrono::steady_clock::now();
     std::chrono::duration<double> elapsed = end - start;
 
     std::cout << "Time:\t" << elapsed.count() << "\n";
-    std::cout << "nA:\t" << env.getNAgents() << "\n";
-    std::cout << "nT:\t" << env.getNTasks() << "\n";
-
+    std::cout << "nA:\t" << result.nAgents << "\n";
+    std::cout << "nT:\t" << result.nTasks << "\n";
 
-    if (pbs.solution_found){
-        pbs.printPaths();
+    if (vm.count("profile_out")){
+        appendProfile(vm["profile_out"].as<std::string>(), result);
     }
 
-
-    pbs.clearSearchEngines();
+    std::cout << paths.str();
 
     return 0;
 }
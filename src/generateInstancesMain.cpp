@@ -1,6 +1,10 @@
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
 #include "instances_generation/EnvGenerator.hpp"
+#include "instances_generation/WarehouseGenerator.hpp"
 
 int main(int argc, char** argv){
     namespace po = boost::program_options;
@@ -9,9 +13,24 @@ int main(int argc, char** argv){
             ("help", "produce help message (use absolute paths or paths relative to working directory)")
             ("grid_path", po::value<std::string>()->default_value("./data/grid.txt"), "path of grid file")
             ("instances_root", po::value<std::string>()->default_value("./instances"), "path where instances will be placed")
-            ("a", po::value<int>()->required(), "Number of Agents")
-            ("t", po::value<int>()->required(), "Number of Tasks")
-            ("n", po::value<int>()->required(), "Number of Instances");
+            ("a", po::value<int>(), "Number of Agents")
+            ("t", po::value<int>(), "Number of Tasks")
+            ("n", po::value<int>(), "Number of Instances")
+            ("format", po::value<std::string>()->default_value("binary"),
+                "instance file format: binary (<id>.inst), text (<id>.agents and <id>.tasks) or archive (one .cmpa per configuration)")
+            ("seed", po::value<uint64_t>(), "base seed, instance i is drawn from (seed, i) (random if not given)")
+            ("threads", po::value<unsigned>()->default_value(0), "generation threads (0 = hardware threads)")
+            ("warehouse", po::value<std::string>(),
+                "write a synthetic warehouse (grid.txt, endpoints.txt, distance_table.npz) in this directory, "
+                "instances are then generated on its grid if --a, --t and --n are given")
+            ("shelf_rows", po::value<int>()->default_value(WarehouseLayout{}.shelfRows), "warehouse rows of shelf blocks")
+            ("shelf_blocks", po::value<int>()->default_value(WarehouseLayout{}.shelfBlocks), "warehouse shelf blocks per row")
+            ("shelf_length", po::value<int>()->default_value(WarehouseLayout{}.shelfLength), "warehouse shelves per block")
+            ("aisle_width", po::value<int>()->default_value(WarehouseLayout{}.aisleWidth), "warehouse aisle width")
+            ("parking_columns", po::value<int>()->default_value(WarehouseLayout{}.parkingColumns),
+                "warehouse double endpoint columns on each side")
+            ("endpoint_spacing", po::value<int>()->default_value(WarehouseLayout{}.endpointSpacing),
+                "one shelf side cell every endpoint_spacing is an endpoint");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -23,14 +42,63 @@ int main(int argc, char** argv){
 
     po::notify(vm);
 
+    std::string gridPath = vm["grid_path"].as<std::string>();
+    if (vm.count("warehouse")) {
+        WarehouseLayout layout;
+        layout.shelfRows = vm["shelf_rows"].as<int>();
+        layout.shelfBlocks = vm["shelf_blocks"].as<int>();
+        layout.shelfLength = vm["shelf_length"].as<int>();
+        layout.aisleWidth = vm["aisle_width"].as<int>();
+        layout.parkingColumns = vm["parking_columns"].as<int>();
+        layout.endpointSpacing = vm["endpoint_spacing"].as<int>();
+
+        std::optional<WarehouseGenerator> warehouse;
+        try {
+            warehouse.emplace(layout);
+        }
+        catch (const std::invalid_argument &e) {
+            std::cerr << e.what() << " (shelf_rows, shelf_blocks, shelf_length, aisle_width and endpoint_spacing "
+                      << "must be at least 1, parking_columns at least 0)\n" << desc << '\n';
+            return 1;
+        }
+
+        const std::filesystem::path warehouseDir = vm["warehouse"].as<std::string>();
+        const size_t nEndpoints = warehouse->getEndpoints().size();
+        // the endpoint table is quadratic in the endpoints, raise endpoint_spacing to shrink it
+        std::cerr << "warehouse: " << warehouse->getMatrix().getNRows() << 'x' << warehouse->getMatrix().getNCols()
+                  << ", " << nEndpoints << " endpoints, distance table "
+                  << nEndpoints * nEndpoints * sizeof(int32_t) / (1024 * 1024) << " MiB\n";
+        warehouse->save(warehouseDir, vm["threads"].as<unsigned>());
+
+        if (!vm.count("a") && !vm.count("t") && !vm.count("n")) {
+            return 0;
+        }
+        gridPath = (warehouseDir / "grid.txt").string();
+    }
+
+    if (!vm.count("a") || !vm.count("t") || !vm.count("n")) {
+        std::cerr << "--a, --t and --n are required to generate instances\n";
+        return 1;
+    }
+
     const std::string instancesRoot = vm["instances_root"].as<std::string>();
+    const std::string format = vm["format"].as<std::string>();
+
+    const uint64_t seed = vm.count("seed") ? vm["seed"].as<uint64_t>() :
+        (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    if (!vm.count("seed")) {
+        std::cerr << "seed: " << seed << '\n';
+    }
 
-    EnvGenerator grid(vm["grid_path"].as<std::string>() + "");
+    EnvGenerator grid(gridPath);
     auto path = grid.generateEnvs(
             vm["n"].as<int>(),
             vm["a"].as<int>(),
             vm["t"].as<int>(),
-            instancesRoot
+            instancesRoot,
+            format == "text" ? InstanceFormat::TEXT : (format == "archive" ? InstanceFormat::ARCHIVE : InstanceFormat::BINARY),
+            seed,
+            vm["threads"].as<unsigned>()
     );
 
     return 0;
@@ -0,0 +1,164 @@
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "instances_evaluation/AssignmentCache.hpp"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using assignment_cache::Record;
+
+    // exclusive lock on <cachePath>.lock for the lifetime of the object, shared by threads and processes
+    class FileLock{
+    public:
+        explicit FileLock(const std::filesystem::path &cachePath){
+#ifndef WIN32
+            auto lockPath = cachePath;
+            lockPath += ".lock";
+            fd = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd >= 0 && flock(fd, LOCK_EX) != 0){
+                close(fd);
+                fd = -1;
+            }
+#endif
+        }
+
+        ~FileLock(){
+#ifndef WIN32
+            if (fd >= 0){
+                flock(fd, LOCK_UN);
+                close(fd);
+            }
+#endif
+        }
+
+        FileLock(const FileLock&) = delete;
+        FileLock& operator=(const FileLock&) = delete;
+
+        [[nodiscard]] bool isLocked() const{
+#ifndef WIN32
+            return fd >= 0;
+#else
+            return true;
+#endif
+        }
+    private:
+        int fd = -1;
+    };
+
+    // <cachePath>.<pid>.<thread>.tmp, no other writer renames it
+    std::filesystem::path tmpPathOf(const std::filesystem::path &cachePath){
+        std::ostringstream suffix;
+#ifndef WIN32
+        suffix << '.' << getpid();
+#endif
+        suffix << '.' << std::hash<std::thread::id>{}(std::this_thread::get_id()) << ".tmp";
+        auto tmpPath = cachePath;
+        tmpPath += suffix.str();
+        return tmpPath;
+    }
+
+    // every well formed record of a cache file, records without a solve time are dropped
+    std::map<uint64_t, Record> readRecords(const std::filesystem::path &cachePath){
+        std::map<uint64_t, Record> records;
+        std::ifstream file{cachePath};
+        std::string line;
+
+        while (std::getline(file, line)){
+            std::istringstream keyLine{line};
+            std::string tag;
+            uint64_t key;
+            size_t nAgents;
+            if (!(keyLine >> tag >> std::hex >> key) || tag != "key" || !(file >> nAgents)){
+                break;
+            }
+            file.ignore();
+            double solveTime;
+            const bool timed = static_cast<bool>(keyLine >> std::dec >> solveTime);
+
+            TASolution assignment(nAgents);
+            for (auto& waypoints : assignment){
+                if (!std::getline(file, line)){
+                    return records;
+                }
+                std::istringstream values{line};
+                size_t nWaypoints;
+                char separator;
+                values >> nWaypoints;
+                waypoints.resize(nWaypoints);
+                for (auto& cell : waypoints){
+                    values >> separator >> cell;
+                }
+                if (!values){
+                    return records;
+                }
+            }
+            if (timed){
+                records[key] = {std::move(assignment), solveTime};
+            }
+        }
+
+        return records;
+    }
+}
+
+std::optional<Record> assignment_cache::load(const std::filesystem::path &cachePath, uint64_t key) {
+    auto records = readRecords(cachePath);
+    auto record = records.find(key);
+    if (record == records.end()){
+        return std::nullopt;
+    }
+    return std::move(record->second);
+}
+
+bool assignment_cache::store(const std::filesystem::path &cachePath, uint64_t key, const Record &record) {
+    std::error_code error;
+    std::filesystem::create_directories(cachePath.parent_path(), error);
+
+    const FileLock lock{cachePath};
+    if (!lock.isLocked()){
+        return false;
+    }
+
+    auto records = readRecords(cachePath);
+    records[key] = record;
+
+    const auto tmpPath = tmpPathOf(cachePath);
+    {
+        std::ofstream file{tmpPath, std::ios::trunc};
+        if (!file.is_open()){
+            return false;
+        }
+        for (const auto& [recordKey, cached] : records){
+            file << "key " << std::hex << std::setw(16) << std::setfill('0') << recordKey << std::dec
+                 << ' ' << cached.solveTime << "\n" << cached.assignment.size() << "\n";
+            for (const auto& waypoints : cached.assignment){
+                file << waypoints.size();
+                for (auto cell : waypoints){
+                    file << ',' << cell;
+                }
+                file << "\n";
+            }
+        }
+        if (!file){
+            file.close();
+            std::filesystem::remove(tmpPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, cachePath, error);
+    if (error){
+        std::filesystem::remove(tmpPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,265 @@
+#include <charconv>
+#include <stdexcept>
+#include "instances_evaluation/AssignmentProtocol.hpp"
+
+namespace {
+    // just enough JSON for the protocol: objects, arrays, integers and strings without unicode escapes
+    class JsonReader{
+    public:
+        explicit JsonReader(std::string_view text) : text{text} {}
+
+        void expect(char c){
+            if (peek() != c){
+                fail(std::string("expected '") + c + "'");
+            }
+            ++pos;
+        }
+
+        bool consume(char c){
+            if (peek() != c){
+                return false;
+            }
+            ++pos;
+            return true;
+        }
+
+        char peek(){
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')){
+                ++pos;
+            }
+            return pos < text.size() ? text[pos] : '\0';
+        }
+
+        int64_t readInt(){
+            peek();
+            int64_t value = 0;
+            auto [end, error] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+            if (error != std::errc{}){
+                fail("expected an integer");
+            }
+            pos = end - text.data();
+            return value;
+        }
+
+        std::string readString(){
+            expect('"');
+            std::string value;
+            while (pos < text.size() && text[pos] != '"'){
+                if (text[pos] == '\\' && pos + 1 < text.size()){
+                    ++pos;
+                }
+                value += text[pos++];
+            }
+            expect('"');
+            return value;
+        }
+
+        // onElement reads one element
+        template<typename F>
+        void readArray(F onElement){
+            expect('[');
+            if (consume(']')){
+                return;
+            }
+            do{
+                onElement();
+            } while (consume(','));
+            expect(']');
+        }
+
+        // onMember(key) reads the value of key
+        template<typename F>
+        void readObject(F onMember){
+            expect('{');
+            if (consume('}')){
+                return;
+            }
+            do{
+                auto key = readString();
+                expect(':');
+                onMember(key);
+            } while (consume(','));
+            expect('}');
+        }
+
+        void skipValue(){
+            switch (peek()){
+                case '{':
+                    readObject([this](const std::string&){ skipValue(); });
+                    break;
+                case '[':
+                    readArray([this](){ skipValue(); });
+                    break;
+                case '"':
+                    readString();
+                    break;
+                default:
+                    while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']'){
+                        ++pos;
+                    }
+            }
+        }
+
+        void end(){
+            if (peek() != '\0'){
+                fail("trailing characters");
+            }
+        }
+
+        [[noreturn]] void fail(const std::string &message) const{
+            throw std::invalid_argument("assignment JSON, offset " + std::to_string(pos) + ": " + message);
+        }
+    private:
+        std::string_view text;
+        size_t pos = 0;
+    };
+
+    template<typename Container>
+    void writeIntArray(std::string &out, const Container &values){
+        out += '[';
+        for (size_t i = 0 ; i < values.size() ; ++i){
+            if (i > 0){
+                out += ',';
+            }
+            out += std::to_string(values[i]);
+        }
+        out += ']';
+    }
+
+    std::vector<int64_t> readIntArray(JsonReader &reader){
+        std::vector<int64_t> values;
+        reader.readArray([&reader, &values](){ values.push_back(reader.readInt()); });
+        return values;
+    }
+
+    ReducedInstance readInstance(JsonReader &reader){
+        ReducedInstance instance;
+        reader.readObject([&reader, &instance](const std::string &key){
+            if (key == "n_rows"){
+                instance.nRows = static_cast<size_t>(reader.readInt());
+            }
+            else if (key == "n_cols"){
+                instance.nCols = static_cast<size_t>(reader.readInt());
+            }
+            else if (key == "agents"){
+                instance.agents = readIntArray(reader);
+            }
+            else if (key == "tasks"){
+                reader.readArray([&reader, &instance](){
+                    auto task = readIntArray(reader);
+                    if (task.size() != 2){
+                        reader.fail("a task is a [pickup, delivery] pair");
+                    }
+                    instance.tasks.emplace_back(task[0], task[1]);
+                });
+            }
+            else if (key == "distances"){
+                reader.readArray([&reader, &instance](){ instance.distanceMatrix.push_back(readIntArray(reader)); });
+            }
+            else{
+                reader.skipValue();
+            }
+        });
+        return instance;
+    }
+}
+
+std::string assignment_protocol::writeRequest(const Request &request) {
+    std::string out = "{\"capacity\":" + std::to_string(request.capacity) + ",\"instances\":[";
+    for (size_t i = 0 ; i < request.instances.size() ; ++i){
+        const auto& instance = request.instances[i];
+        out += i > 0 ? ",{" : "{";
+        out += "\"n_rows\":" + std::to_string(instance.nRows) + ",\"n_cols\":" + std::to_string(instance.nCols);
+        out += ",\"agents\":";
+        writeIntArray(out, instance.agents);
+        out += ",\"tasks\":[";
+        for (size_t t = 0 ; t < instance.tasks.size() ; ++t){
+            out += (t > 0 ? ",[" : "[") + std::to_string(instance.tasks[t].first) + "," +
+                std::to_string(instance.tasks[t].second) + "]";
+        }
+        out += "],\"distances\":[";
+        for (size_t row = 0 ; row < instance.distanceMatrix.size() ; ++row){
+            if (row > 0){
+                out += ',';
+            }
+            writeIntArray(out, instance.distanceMatrix[row]);
+        }
+        out += "]}";
+    }
+    out += "]}";
+    return out;
+}
+
+assignment_protocol::Request assignment_protocol::readRequest(std::string_view body) {
+    JsonReader reader{body};
+    Request request;
+    reader.readObject([&reader, &request](const std::string &key){
+        if (key == "capacity"){
+            request.capacity = static_cast<int>(reader.readInt());
+        }
+        else if (key == "instances"){
+            reader.readArray([&reader, &request](){ request.instances.push_back(readInstance(reader)); });
+        }
+        else{
+            reader.skipValue();
+        }
+    });
+    reader.end();
+    return request;
+}
+
+std::string assignment_protocol::writeResponse(const std::vector<TASolution> &assignments) {
+    std::string out = "{\"assignments\":[";
+    for (size_t i = 0 ; i < assignments.size() ; ++i){
+        out += i > 0 ? ",[" : "[";
+        for (size_t agent = 0 ; agent < assignments[i].size() ; ++agent){
+            if (agent > 0){
+                out += ',';
+            }
+            writeIntArray(out, assignments[i][agent]);
+        }
+        out += ']';
+    }
+    out += "]}";
+    return out;
+}
+
+std::vector<TASolution> assignment_protocol::readResponse(std::string_view body) {
+    JsonReader reader{body};
+    std::vector<TASolution> assignments;
+    std::string error;
+    reader.readObject([&reader, &assignments, &error](const std::string &key){
+        if (key == "assignments"){
+            reader.readArray([&reader, &assignments](){
+                auto& assignment = assignments.emplace_back();
+                reader.readArray([&reader, &assignment](){
+                    auto route = readIntArray(reader);
+                    assignment.emplace_back(route.begin(), route.end());
+                });
+            });
+        }
+        else if (key == "error"){
+            error = reader.readString();
+        }
+        else{
+            reader.skipValue();
+        }
+    });
+    reader.end();
+    if (!error.empty()){
+        throw std::runtime_error("assignment service: " + error);
+    }
+    return assignments;
+}
+
+std::string assignment_protocol::writeError(const std::string &message) {
+    std::string out = "{\"error\":\"";
+    for (char c : message){
+        if (c == '"' || c == '\\'){
+            out += '\\';
+        }
+        out += (c == '\n' || c == '\r') ? ' ' : c;
+    }
+    out += "\"}";
+    return out;
+}
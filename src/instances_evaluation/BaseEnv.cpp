@@ -4,33 +4,35 @@
 #include <random>
 #include <cstdint>
 #include <algorithm>
+#include <stdexcept>
 #include <boost/tokenizer.hpp>
 #include "instances_evaluation/BaseEnv.hpp"
+#include "InstanceFile.hpp"
+#include "Profiler.h"
+
+static Profiler::Timer& loadInstanceTimer = Profiler::instance().getTimer("load_instance");
+static Profiler::Timer& loadDistanceMatrixTimer = Profiler::instance().getTimer("load_distance_matrix");
+static Profiler::Timer& reduceMatrixTimer = Profiler::instance().getTimer("reduce_matrix");
+static Profiler::Timer& loadGridTimer = Profiler::instance().getTimer("load_grid");
 
 int64_t BaseEnv::from2Dto1D(int64_t x, int64_t y, size_t nCols) {
     return y * static_cast<int64_t>(nCols) + x;
 }
 
-CompressedDistanceMatrix BaseEnv::loadDistanceMatrix(const std::filesystem::path &distanceMatrixPath) {
-    const cnpy::NpyArray distanceMatrixObj = cnpy::npy_load(distanceMatrixPath);
-
-    unsigned startCoordsSize = distanceMatrixObj.shape[0] * distanceMatrixObj.shape[1];
-    unsigned endCoordsSize = distanceMatrixObj.shape[2] * distanceMatrixObj.shape[3];
-
-    // distance matrix is considered double
-    const auto* data = distanceMatrixObj.data<double>();
-    CompressedDistanceMatrix distanceMatrix(startCoordsSize, std::vector<int64_t>(endCoordsSize));
-
-    for (unsigned i = 0 ; i < startCoordsSize ; ++i){
-        for (unsigned j = 0 ; j < endCoordsSize ; ++j){
-            distanceMatrix[i][j] = static_cast<int>(data[i*startCoordsSize + j]);
-        }
-    }
-
-    return distanceMatrix;
+DistanceTable BaseEnv::loadDistanceMatrix(const std::filesystem::path &distanceMatrixPath) {
+    ScopedTimer timer{loadDistanceMatrixTimer};
+    return DistanceTable::load(distanceMatrixPath);
 }
 
 CompressedCoordVector BaseEnv::extractRobotPositions(const std::filesystem::path &agentsFilePath, size_t &nRows, size_t &nCols) {
+    ScopedTimer timer{loadInstanceTimer};
+    if (instance_file::isBinary(agentsFilePath)){
+        const InstanceFileView view{agentsFilePath};
+        nRows = view.getNRows();
+        nCols = view.getNCols();
+        return agentsFromView(view);
+    }
+
     std::fstream fs;
     fs.open(agentsFilePath, std::ios::in);
 
@@ -68,6 +70,15 @@ CompressedCoordVector BaseEnv::extractRobotPositions(const std::filesystem::path
 }
 
 CompressedTasksVector BaseEnv::extractTasks(const std::filesystem::path &taskFilePath, size_t nCols) {
+    ScopedTimer timer{loadInstanceTimer};
+    if (instance_file::isBinary(taskFilePath)){
+        const InstanceFileView view{taskFilePath};
+        if (view.getNCols() != nCols){
+            throw std::runtime_error("agents and tasks of " + taskFilePath.string() + " are on different grids");
+        }
+        return tasksFromView(view);
+    }
+
     std::fstream fs;
     fs.open(taskFilePath, std::ios::in);
 
@@ -103,6 +114,19 @@ CompressedTasksVector BaseEnv::extractTasks(const std::filesystem::path &taskFil
     return tasks;
 }
 
+CompressedCoordVector BaseEnv::agentsFromView(const InstanceFileView &view) {
+    return {view.agents(), view.agents() + view.getNAgents()};
+}
+
+CompressedTasksVector BaseEnv::tasksFromView(const InstanceFileView &view) {
+    CompressedTasksVector tasks;
+    tasks.reserve(view.getNTasks());
+    for (const auto* task = view.tasks() ; task != view.tasks() + 2 * static_cast<size_t>(view.getNTasks()) ; task += 2){
+        tasks.emplace_back(task[0], task[1]);
+    }
+    return tasks;
+}
+
 BaseEnv::BaseEnv(const std::filesystem::path &agentsFilePath, const std::filesystem::path &taskFilePath,
                  const std::filesystem::path &distanceMatrixPath) :
     agents{extractRobotPositions(agentsFilePath, nRows, nCols)},
@@ -110,13 +134,51 @@ BaseEnv::BaseEnv(const std::filesystem::path &agentsFilePath, const std::filesys
     distanceMatrix{loadReducedDistanceMatrix(distanceMatrixPath, agents, tasks)}
     {}
 
+BaseEnv::BaseEnv(const std::filesystem::path &agentsFilePath, const std::filesystem::path &taskFilePath,
+                 const DistanceTable &fullDistanceMatrix) :
+    agents{extractRobotPositions(agentsFilePath, nRows, nCols)},
+    tasks{extractTasks(taskFilePath, nCols)},
+    distanceMatrix{reduceMatrix(agents, tasks, fullDistanceMatrix)}
+    {}
+
+BaseEnv::BaseEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix) :
+    agents{agentsFromView(instance)},
+    tasks{tasksFromView(instance)},
+    distanceMatrix{reduceMatrix(agents, tasks, fullDistanceMatrix)},
+    nRows{instance.getNRows()},
+    nCols{instance.getNCols()}
+    {}
+
+BaseEnv::BaseEnv(ReducedInstance instance) :
+    agents{std::move(instance.agents)},
+    tasks{std::move(instance.tasks)},
+    distanceMatrix{std::move(instance.distanceMatrix)},
+    nRows{instance.nRows},
+    nCols{instance.nCols}
+{
+    if (distanceMatrix.size() != agents.size() + 2 * tasks.size() + 1){
+        throw std::invalid_argument("the reduced distance matrix has " + std::to_string(distanceMatrix.size()) +
+                                    " rows, expected " + std::to_string(agents.size() + 2 * tasks.size() + 1));
+    }
+    for (const auto& row : distanceMatrix){
+        if (row.size() != distanceMatrix.size()){
+            throw std::invalid_argument("the reduced distance matrix is not square");
+        }
+    }
+}
+
+ReducedInstance BaseEnv::getReducedInstance() const {
+    return {nRows, nCols, agents, tasks, distanceMatrix};
+}
+
 CompressedDistanceMatrix BaseEnv::loadReducedDistanceMatrix(const std::filesystem::path &distanceMatrixPath, const CompressedCoordVector &agents,
                                                             const CompressedTasksVector &tasks) {
     return reduceMatrix(agents, tasks, loadDistanceMatrix(distanceMatrixPath));
 }
 
 CompressedDistanceMatrix BaseEnv::reduceMatrix(const CompressedCoordVector &agents, const CompressedTasksVector &tasks,
-                                               CompressedDistanceMatrix && distanceMatrix) {
+                                               const DistanceTable &distanceMatrix) {
+    ScopedTimer timer{reduceMatrixTimer};
     // extract useful indices
     std::vector<int64_t> reducedIndices;
     reducedIndices.reserve(agents.size() + tasks.size() * 2);
@@ -130,6 +192,12 @@ CompressedDistanceMatrix BaseEnv::reduceMatrix(const CompressedCoordVector &agen
         reducedIndices.push_back(coordEnd);
     }
 
+    for(auto i : reducedIndices){
+        if (!distanceMatrix.contains(i)){
+            throw std::out_of_range("cell " + std::to_string(i) + " is not in the distance table");
+        }
+    }
+
     size_t reducedSize = reducedIndices.size();
 
     CompressedDistanceMatrix reducedMatrix;
@@ -141,7 +209,7 @@ CompressedDistanceMatrix BaseEnv::reduceMatrix(const CompressedCoordVector &agen
         reducedRow.reserve(reducedSize+1);
 
         for(auto j : reducedIndices){
-            reducedRow.push_back(distanceMatrix[i][j]);
+            reducedRow.push_back(distanceMatrix(i, j));
         }
         // end location = actual agent location
         reducedRow.push_back(0);
@@ -163,22 +231,24 @@ int64_t BaseEnv::getMaxDistance() const {
 }
 
 std::vector<bool> BaseEnv::getGrid(const std::filesystem::path &mapPath) const {
-    using namespace boost;
+    return loadGrid(mapPath, nRows, nCols);
+}
 
-    std::vector<bool> grid;
+std::vector<bool> BaseEnv::loadGrid(const std::filesystem::path &mapPath, size_t nRows, size_t nCols) {
+    ScopedTimer timer{loadGridTimer};
 
     std::ifstream myfile(mapPath, std::ios::in);
     if (!myfile.is_open())
         throw std::runtime_error("wrong grid file");
 
     std::string line;
-    grid.reserve(nRows * nCols);
+    std::vector<bool> grid(nRows * nCols);
 
     // read map (&& start/goal locations)
-    for (int i = 0; i < nRows; i++) {
+    for (size_t i = 0; i < nRows; i++) {
         getline(myfile, line);
-        for (int j = 0; j < nCols; j++) {
-            grid[linearizeCoord({i, j})] = (line[j] == '@');
+        for (size_t j = 0; j < nCols; j++) {
+            grid[from2Dto1D(static_cast<int64_t>(j), static_cast<int64_t>(i), nCols)] = (line[j] == '@');
         }
     }
 
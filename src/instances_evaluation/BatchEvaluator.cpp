@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include "instances_evaluation/AssignmentCache.hpp"
+#include "instances_evaluation/BatchEvaluator.hpp"
+#include "instances_evaluation/InsertionEnv.hpp"
+#include "instances_evaluation/OrtoolsEnv.hpp"
+#include "commonFunctions.hpp"
+#include "Instance.h"
+#include "InstanceFile.hpp"
+#include "Profiler.h"
+
+static Profiler::Counter& assignmentCacheHits = Profiler::instance().getCounter("assignment_cache_hits");
+
+namespace {
+    std::chrono::milliseconds remoteTimeout(const EvaluationSettings &settings){
+        if (std::isinf(settings.instanceTimeLimit)){
+            return settings.remoteTimeout;
+        }
+        const auto instanceLimit = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::duration<double>(settings.instanceTimeLimit));
+        return std::max(std::min(settings.remoteTimeout, instanceLimit), std::chrono::milliseconds{1});
+    }
+}
+
+std::string InstanceFiles::name() const {
+    return archiveId >= 0 ? std::to_string(archiveId) : agents.stem().string();
+}
+
+BatchEvaluator::BatchEvaluator(const std::filesystem::path &gridPath, const std::filesystem::path &distanceMatrixPath,
+                               EvaluationSettings settings) :
+    settings{settings},
+    distanceMatrix{BaseEnv::loadDistanceMatrix(distanceMatrixPath)},
+    heuristics{std::make_shared<HeuristicTable>()},
+    remoteAssigner{settings.assigner == TaskAssigner::REMOTE ?
+        std::make_unique<RemoteAssigner>(settings.remoteHost, settings.remotePort, settings.remoteBatchSize,
+                                         settings.remoteLinger, remoteTimeout(settings)) :
+        nullptr}
+{
+    std::ifstream gridFile{gridPath};
+    if (!gridFile.is_open()){
+        throw std::runtime_error("wrong grid file");
+    }
+
+    std::string line;
+    while (std::getline(gridFile, line) && !line.empty()){
+        nCols = line.size();
+        ++nRows;
+    }
+
+    if (distanceMatrix.getNCells() != nRows * nCols){
+        throw std::runtime_error("the distance matrix does not match the " + std::to_string(nRows) + "x" +
+                                 std::to_string(nCols) + " grid");
+    }
+
+    grid = BaseEnv::loadGrid(gridPath, nRows, nCols);
+}
+
+EvaluationResult BatchEvaluator::evaluate(const InstanceFiles &instance, const SolvedCallback &onSolved) const {
+    return findPaths(assign(instance), onSolved);
+}
+
+template<typename Env>
+Env BatchEvaluator::loadEnv(const InstanceFiles &instance) const {
+    return instance.archiveId >= 0 ?
+        Env(getArchive(instance.agents)->get(static_cast<uint32_t>(instance.archiveId)), distanceMatrix) :
+        Env(instance.agents, instance.tasks, distanceMatrix);
+}
+
+void BatchEvaluator::checkGridSize(const BaseEnv &env, const InstanceFiles &instance) const {
+    if (env.getNRows() != nRows || env.getNCols() != nCols){
+        throw std::runtime_error("instance " + instance.agents.string() + " " + instance.name() + " does not match the grid size");
+    }
+}
+
+AssignedInstance BatchEvaluator::assign(const InstanceFiles &instance) const {
+    using Clock = std::chrono::steady_clock;
+    AssignedInstance assigned{EvaluationResult{instance}};
+    auto& result = assigned.result;
+
+    auto start = Clock::now();
+    auto deadline = std::isinf(settings.instanceTimeLimit) ? Clock::time_point::max() :
+        start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings.instanceTimeLimit));
+
+    if (settings.assigner == TaskAssigner::REMOTE){
+        // concurrent calls from the scheduler threads are batched by the assigner, never cached
+        const auto env = loadEnv<RemoteEnv>(instance);
+        checkGridSize(env, instance);
+        result.nAgents = env.getNAgents();
+        result.nTasks = env.getNTasks();
+        assigned.assignment = env.solve(settings.capacity, *remoteAssigner);
+    }
+    else if (settings.assigner == TaskAssigner::INSERTION){
+        // milliseconds, never cached
+        const auto env = loadEnv<InsertionEnv>(instance);
+        checkGridSize(env, instance);
+        result.nAgents = env.getNAgents();
+        result.nTasks = env.getNTasks();
+        assigned.assignment = env.solve(settings.capacity);
+    }
+    else{
+        const auto env = loadEnv<OrtoolsEnv>(instance);
+        checkGridSize(env, instance);
+        result.nAgents = env.getNAgents();
+        result.nTasks = env.getNTasks();
+
+        std::filesystem::path cachePath;
+        uint64_t key = 0;
+        std::optional<assignment_cache::Record> cached;
+        if (settings.cacheAssignments){
+            cachePath = getAssignmentCachePath(instance, result.nAgents, result.nTasks);
+            key = env.assignmentKey(settings.capacity, settings.ortools);
+            cached = assignment_cache::load(cachePath, key);
+        }
+
+        if (cached){
+            // the solve time of the run that stored it, so that PBS gets the same share of the instance budget
+            assignmentCacheHits.add();
+            assigned.assignment = std::move(cached->assignment);
+            result.assignmentCached = true;
+            result.assignmentTime = cached->solveTime;
+        }
+        else{
+            assigned.assignment = env.solve(settings.capacity, deadline, settings.ortools, nullptr, settings.threadBudget);
+            const double solveTime = std::chrono::duration<double>(Clock::now() - start).count();
+            if (settings.cacheAssignments && !assigned.assignment.empty() &&
+                !assignment_cache::store(cachePath, key, {assigned.assignment, solveTime})){
+                std::cerr << "cannot write the assignment cache " << cachePath.string() << "\n";
+            }
+        }
+    }
+    if (!result.assignmentCached){
+        result.assignmentTime = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    result.time = result.assignmentTime;
+
+    return assigned;
+}
+
+EvaluationResult BatchEvaluator::findPaths(AssignedInstance assigned, const SolvedCallback &onSolved) const {
+    using Clock = std::chrono::steady_clock;
+    auto& result = assigned.result;
+    const auto& instance = result.instance;
+
+    // time spent waiting between the two stages is not charged to the instance
+    auto pbsTimeLimit = std::min(settings.pbsTimeLimit, settings.instanceTimeLimit - result.assignmentTime);
+    if (assigned.assignment.empty() || pbsTimeLimit <= 0){
+        // no assignment within the instance budget: reported as unsolved
+        return result;
+    }
+
+    auto start = Clock::now();
+    Instance pbsInstance(grid, std::move(assigned.assignment), static_cast<int>(nRows), static_cast<int>(nCols), heuristics);
+    PBS pbs(pbsInstance, true, 0, 0);
+    pbs.setHighLevelSearch(settings.hlSearch);
+    pbs.setConflictSelectionRule(settings.conflictRule);
+
+    if (settings.anytime != ANYTIME_OFF){
+        // improved solutions go to stderr, stdout keeps the format parsed by info_extractor.py
+        auto name = instance.name();
+        pbs.setAnytime(
+            settings.anytime,
+            [name](double runtime, size_t makespan, int sumOfCosts, const vector<Path*>&){
+                std::cerr << "Improved:\t" << name << "\t" << runtime << "\t" << makespan << "\t" << sumOfCosts << std::endl;
+            }
+        );
+    }
+
+    pbs.solve(pbsTimeLimit);
+    auto end = Clock::now();
+
+    result.pathFindingTime = std::chrono::duration<double>(end - start).count();
+    result.time = result.assignmentTime + result.pathFindingTime;
+    result.solutionFound = pbs.solution_found;
+    result.hlExpanded = pbs.num_HL_expanded;
+    result.llExpanded = pbs.num_LL_expanded;
+
+    if (pbs.solution_found){
+        result.makespan = pbs.solution_cost;
+        result.sumOfCosts = pbs.goal_node->cost;
+        if (onSolved){
+            onSolved(instance, pbs);
+        }
+    }
+
+    pbs.clearSearchEngines();
+    return result;
+}
+
+std::vector<InstanceFiles> BatchEvaluator::listInstances(const std::filesystem::path &instancesDir) {
+    namespace fs = std::filesystem;
+
+    std::vector<std::pair<int, InstanceFiles>> indexed;
+    for (const auto& entry : fs::directory_iterator(instancesDir)){
+        const auto& path = entry.path();
+        const auto stem = path.stem().string();
+        if (stem.empty() || !std::all_of(stem.cbegin(), stem.cend(), ::isdigit)){
+            continue;
+        }
+
+        // a binary instance holds both agents and tasks, and wins over a text pair with the same id
+        if (path.extension() == instance_file::extension){
+            indexed.push_back({std::stoi(stem), {path, path}});
+            continue;
+        }
+        if (path.extension() != ".agents" || fs::exists(fs::path{path}.replace_extension(instance_file::extension))){
+            continue;
+        }
+        auto tasksPath = fs::path{path}.replace_extension(".tasks");
+        if (!fs::exists(tasksPath)){
+            continue;
+        }
+        indexed.push_back({std::stoi(stem), {path, tasksPath}});
+    }
+
+    std::sort(indexed.begin(), indexed.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+
+    std::vector<InstanceFiles> instances;
+    instances.reserve(indexed.size());
+    for (auto& [id, files] : indexed){
+        instances.push_back(std::move(files));
+    }
+    return instances;
+}
+
+std::filesystem::path BatchEvaluator::getAssignmentCachePath(const InstanceFiles &instance, int nAgents, int nTasks) {
+    const auto name = instance.name();
+    if (name.empty() || !std::all_of(name.cbegin(), name.cend(), ::isdigit)){
+        return instance.agents.parent_path() / OrtoolsEnv::methodString / (name + "." + assignment_cache::extension);
+    }
+
+    // <root>/a<A>_t<T>.cmpa or <root>/a<A>_t<T>/<id>.inst
+    const auto instancesRoot = instance.archiveId >= 0 ? instance.agents.parent_path() :
+        instance.agents.parent_path().parent_path();
+    return getFilePath(nAgents, nTasks, std::stoi(name), instancesRoot, assignment_cache::extension,
+                       OrtoolsEnv::methodString);
+}
+
+std::shared_ptr<const InstanceArchive> BatchEvaluator::getArchive(const std::filesystem::path &archivePath) const {
+    std::lock_guard lock{archivesMutex};
+    auto& archive = archives[archivePath];
+    if (!archive){
+        archive = std::make_shared<const InstanceArchive>(archivePath);
+    }
+    return archive;
+}
+
+std::vector<InstanceFiles> BatchEvaluator::listArchive(const std::filesystem::path &archivePath) {
+    std::vector<InstanceFiles> instances;
+    for (auto id : InstanceArchive{archivePath}.getIds()){
+        instances.push_back({archivePath, archivePath, id});
+    }
+    return instances;
+}
+
+std::vector<InstanceFiles> BatchEvaluator::readManifest(const std::filesystem::path &manifestPath) {
+    std::ifstream manifest{manifestPath};
+    if (!manifest.is_open()){
+        throw std::runtime_error("wrong manifest file");
+    }
+
+    const auto root = manifestPath.parent_path();
+    std::vector<InstanceFiles> instances;
+    std::string line;
+
+    while (std::getline(manifest, line)){
+        std::stringstream lineStream{line};
+        std::string agents, tasks;
+        if (!(lineStream >> agents) || agents.front() == '#'){
+            continue;
+        }
+        if (!(lineStream >> tasks)){
+            // binary instance file
+            tasks = agents;
+        }
+        instances.push_back({root / agents, root / tasks});
+    }
+
+    return instances;
+}
+
+void BatchEvaluator::writeHeader(std::ostream &os) {
+    os << "agents\ttasks\tnA\tnT\ttime\tassignment time\tpath finding time\tsolution found\tmakespan\tsum of costs\t"
+       << "#high-level expanded\t#low-level expanded\tassignment cached\n";
+}
+
+void BatchEvaluator::writeResult(std::ostream &os, const EvaluationResult &result) {
+    const auto& instance = result.instance;
+    const auto record = instance.archiveId >= 0 ? "#" + std::to_string(instance.archiveId) : "";
+    os << instance.agents.string() << record << "\t" << instance.tasks.string() << record << "\t"
+       << result.nAgents << "\t" << result.nTasks << "\t"
+       << result.time << "\t" << result.assignmentTime << "\t" << result.pathFindingTime << "\t"
+       << result.solutionFound << "\t" << result.makespan << "\t" << result.sumOfCosts << "\t"
+       << result.hlExpanded << "\t" << result.llExpanded << "\t" << result.assignmentCached << "\n";
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include "instances_evaluation/InsertionEnv.hpp"
+#include "Profiler.h"
+
+static Profiler::Timer& insertionTimer = Profiler::instance().getTimer("insertion_assignment");
+
+InsertionEnv::InsertionEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath,
+                           const DistanceTable &fullDistanceMatrix) :
+    BaseEnv(mapFilePath, taskFilePath, fullDistanceMatrix)
+    {}
+
+InsertionEnv::InsertionEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix) :
+    BaseEnv(instance, fullDistanceMatrix)
+    {}
+
+InsertionEnv::InsertionEnv(ReducedInstance instance) :
+    BaseEnv(std::move(instance))
+    {}
+
+int64_t InsertionEnv::distance(int from, int to) const {
+    return distanceMatrix[from][to];
+}
+
+int64_t InsertionEnv::routeLength(const Route &route, int agent) const {
+    int64_t length = 0;
+    int previous = agent;
+    for (int node : route.nodes){
+        length += distance(previous, node);
+        previous = node;
+    }
+    return length;
+}
+
+insertion::Insertion InsertionEnv::bestInsertion(const Route &route, int agent, size_t task, int capacity) const {
+    const int nAgents = static_cast<int>(agents.size());
+    const int nPositions = static_cast<int>(route.nodes.size());
+
+    insertion::Positions positions{std::vector<int64_t>(nPositions + 1, agent), std::vector<int>(nPositions + 1, 0)};
+    for (int position = 1 ; position <= nPositions ; ++position){
+        const int node = route.nodes[position - 1];
+        positions.cells[position] = node;
+        positions.load[position] = positions.load[position - 1] + ((node - nAgents) % 2 == 0 ? 1 : -1);
+    }
+
+    const int64_t pickup = nAgents + 2 * static_cast<int64_t>(task);
+    return insertion::bestInsertion(positions, pickup, pickup + 1, capacity, 0, [this](int64_t from, int64_t to){
+        return distanceMatrix[from][to];
+    });
+}
+
+void InsertionEnv::insert(Route &route, int agent, size_t task, const insertion::Insertion &insertion) const {
+    const int pickup = static_cast<int>(agents.size() + 2 * task);
+    insertion::insert(route.nodes, insertion, pickup, pickup + 1);
+    route.length = routeLength(route, agent);
+}
+
+void InsertionEnv::remove(Route &route, int agent, size_t task) const {
+    const int pickup = static_cast<int>(agents.size() + 2 * task);
+    route.nodes.erase(std::remove_if(route.nodes.begin(), route.nodes.end(), [pickup](int node){
+        return node == pickup || node == pickup + 1;
+    }), route.nodes.end());
+    route.length = routeLength(route, agent);
+}
+
+TASolution InsertionEnv::solve(int capacity, int maxLocalSearchMoves) const {
+    ScopedTimer timer{insertionTimer};
+    if (capacity < 1 && !tasks.empty()){
+        return {};
+    }
+
+    const int nAgents = static_cast<int>(agents.size());
+    auto bestInsertion = [this, capacity](const Route &route, int agent, size_t task){
+        return this->bestInsertion(route, agent, task, capacity);
+    };
+    auto insert = [this](Route &route, int agent, size_t task, const insertion::Insertion &insertion){
+        this->insert(route, agent, task, insertion);
+    };
+    auto remove = [this](Route &route, int agent, size_t task){ this->remove(route, agent, task); };
+    // the pickups of a route
+    auto movableTasks = [nAgents](const Route &route, int){
+        std::vector<size_t> tasks;
+        for (int node : route.nodes){
+            if ((node - nAgents) % 2 == 0){
+                tasks.push_back(static_cast<size_t>(node - nAgents) / 2);
+            }
+        }
+        return tasks;
+    };
+
+    std::vector<size_t> allTasks(tasks.size());
+    for (size_t task = 0 ; task < tasks.size() ; ++task){
+        allTasks[task] = task;
+    }
+    std::vector<Route> routes(nAgents);
+    if (!insertion::regretInsertion(routes, allTasks, bestInsertion, insert).empty()){
+        // only without agents
+        return {};
+    }
+    insertion::relocate(routes, maxLocalSearchMoves, movableTasks, bestInsertion, insert, remove);
+
+    TASolution solution;
+    solution.reserve(agents.size());
+    for (int agent = 0 ; agent < nAgents ; ++agent){
+        std::vector<int> values{static_cast<int>(agents[agent])};
+        for (int node : routes[agent].nodes){
+            const auto& task = tasks[(node - nAgents) / 2];
+            values.push_back(static_cast<int>((node - nAgents) % 2 == 0 ? task.first : task.second));
+        }
+        solution.push_back(std::move(values));
+    }
+    return solution;
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include "instances_evaluation/InstanceScheduler.hpp"
+#include "instances_evaluation/BoundedQueue.hpp"
+
+namespace {
+    // hands results to the callback in input order, buffering those that complete early
+    class OrderedOutput{
+    public:
+        OrderedOutput(size_t nResults, const InstanceScheduler::ResultCallback &onResult) :
+            done(nResults),
+            onResult{onResult}
+            {}
+
+        void complete(size_t index, EvaluationResult result){
+            std::lock_guard lock{mutex};
+            done[index] = std::move(result);
+            while (next < done.size() && done[next].has_value()){
+                onResult(*done[next]);
+                done[next].reset();
+                ++next;
+            }
+        }
+    private:
+        std::mutex mutex;
+        std::vector<std::optional<EvaluationResult>> done;
+        size_t next = 0;
+        const InstanceScheduler::ResultCallback &onResult;
+    };
+
+    void reportFailure(const InstanceFiles &instance, const std::exception &e){
+        std::cerr << "instance " << instance.agents.string() << " failed: " << e.what() << std::endl;
+    }
+}
+
+InstanceScheduler::InstanceScheduler(const BatchEvaluator &evaluator, ThreadBudget &budget) :
+    evaluator{evaluator},
+    budget{budget}
+    {}
+
+void InstanceScheduler::run(const std::vector<InstanceFiles> &instances, const ResultCallback &onResult,
+                            const BatchEvaluator::SolvedCallback &onSolved) const {
+    struct WorkQueue{
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    if (instances.empty()){
+        return;
+    }
+
+    const auto nWorkers = std::min<size_t>(budget.size(), instances.size());
+    std::vector<WorkQueue> queues(nWorkers);
+    for (size_t i = 0 ; i < instances.size() ; ++i){
+        queues[i % nWorkers].jobs.push_back(i);
+    }
+
+    auto nextJob = [&queues, nWorkers](size_t worker) -> std::optional<size_t> {
+        {
+            auto& own = queues[worker];
+            std::lock_guard lock{own.mutex};
+            if (!own.jobs.empty()){
+                auto job = own.jobs.front();
+                own.jobs.pop_front();
+                return job;
+            }
+        }
+        for (size_t k = 1 ; k < nWorkers ; ++k){
+            auto& victim = queues[(worker + k) % nWorkers];
+            std::lock_guard lock{victim.mutex};
+            if (!victim.jobs.empty()){
+                auto job = victim.jobs.back();
+                victim.jobs.pop_back();
+                return job;
+            }
+        }
+        // no job is ever added after the start, so every queue being empty means we are done
+        return std::nullopt;
+    };
+
+    OrderedOutput output{instances.size(), onResult};
+
+    auto work = [&](size_t worker){
+        budget.acquire(1);
+        while (auto job = nextJob(worker)){
+            const auto& instance = instances[*job];
+            try{
+                output.complete(*job, evaluator.evaluate(instance, onSolved));
+            }
+            catch (const std::exception& e){
+                reportFailure(instance, e);
+                output.complete(*job, EvaluationResult{instance});
+            }
+        }
+        budget.release(1);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(nWorkers - 1);
+    for (size_t w = 1 ; w < nWorkers ; ++w){
+        workers.emplace_back(work, w);
+    }
+    work(0);
+
+    for (auto& worker : workers){
+        worker.join();
+    }
+}
+
+void InstanceScheduler::runPipelined(const std::vector<InstanceFiles> &instances, unsigned nAssignmentThreads,
+                                     unsigned nPathFindingThreads, size_t queueSize, const ResultCallback &onResult,
+                                     const BatchEvaluator::SolvedCallback &onSolved) const {
+    // both stages must hold a token at all times, otherwise a full queue could block every assignment worker
+    // while no path finding worker is running
+    if (budget.size() < 2){
+        run(instances, onResult, onSolved);
+        return;
+    }
+    nPathFindingThreads = std::clamp(nPathFindingThreads, 1U, budget.size() - 1);
+    nAssignmentThreads = std::clamp(nAssignmentThreads, 1U, budget.size() - nPathFindingThreads);
+
+    OrderedOutput output{instances.size(), onResult};
+    BoundedQueue<std::pair<size_t, AssignedInstance>> assigned{queueSize};
+    std::atomic<size_t> nextInstance{0};
+    std::atomic<unsigned> runningAssigners{nAssignmentThreads};
+
+    // instances are taken in input order, so the ordered output rarely has to buffer
+    auto assign = [&](){
+        budget.acquire(1);
+        for (auto job = nextInstance++ ; job < instances.size() ; job = nextInstance++){
+            const auto& instance = instances[job];
+            try{
+                assigned.push({job, evaluator.assign(instance)});
+            }
+            catch (const std::exception& e){
+                reportFailure(instance, e);
+                output.complete(job, EvaluationResult{instance});
+            }
+        }
+        budget.release(1);
+        if (--runningAssigners == 0){
+            assigned.close();
+        }
+    };
+
+    auto findPaths = [&](){
+        budget.acquire(1);
+        while (auto item = assigned.pop()){
+            auto& [job, assignedInstance] = *item;
+            try{
+                output.complete(job, evaluator.findPaths(std::move(assignedInstance), onSolved));
+            }
+            catch (const std::exception& e){
+                reportFailure(instances[job], e);
+                output.complete(job, EvaluationResult{instances[job]});
+            }
+        }
+        budget.release(1);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(nAssignmentThreads + nPathFindingThreads);
+    for (unsigned i = 0 ; i < nAssignmentThreads ; ++i){
+        workers.emplace_back(assign);
+    }
+    for (unsigned i = 0 ; i < nPathFindingThreads ; ++i){
+        workers.emplace_back(findPaths);
+    }
+
+    for (auto& worker : workers){
+        worker.join();
+    }
+}
@@ -1,14 +1,54 @@
+#include <algorithm>
 #include <filesystem>
 #include <cassert>
 #include <random>
+#include <thread>
 #include "instances_evaluation/OrtoolsEnv.hpp"
 #include "instances_evaluation/BaseEnv.hpp"
 #include "parameters.hpp"
+#include "Profiler.h"
 #include <sstream>
 
+static Profiler::Timer& probeTimer = Profiler::instance().getTimer("ortools_probe");
+static Profiler::Timer& assignmentTimer = Profiler::instance().getTimer("ortools_assignment");
+
+namespace {
+    // search.timeLimit, cut to what is left before the deadline; <= 0 once it has passed
+    double solveTimeLimit(std::chrono::steady_clock::time_point deadline, const OrtoolsSettings &search){
+        using Clock = std::chrono::steady_clock;
+        if (deadline == Clock::time_point::max()){
+            return search.timeLimit;
+        }
+        return std::min(search.timeLimit, std::chrono::duration<double>(deadline - Clock::now()).count());
+    }
+}
+
 OrtoolsEnv::OrtoolsEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath, const std::filesystem::path &distanceMatrixPath) :
         BaseEnv(mapFilePath, taskFilePath, distanceMatrixPath),
-    coordToIndexMap{buildCoordToIndexMap(agents, tasks)},
+    demands{computeDemands(agents.size(), tasks.size())},
+    manager{
+        buildRoutingIndexManager(static_cast<int>(agents.size()), static_cast<int>(distanceMatrix.size()))
+    }
+    {}
+
+OrtoolsEnv::OrtoolsEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath, const DistanceTable &fullDistanceMatrix) :
+        BaseEnv(mapFilePath, taskFilePath, fullDistanceMatrix),
+    demands{computeDemands(agents.size(), tasks.size())},
+    manager{
+        buildRoutingIndexManager(static_cast<int>(agents.size()), static_cast<int>(distanceMatrix.size()))
+    }
+    {}
+
+OrtoolsEnv::OrtoolsEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix) :
+        BaseEnv(instance, fullDistanceMatrix),
+    demands{computeDemands(agents.size(), tasks.size())},
+    manager{
+        buildRoutingIndexManager(static_cast<int>(agents.size()), static_cast<int>(distanceMatrix.size()))
+    }
+    {}
+
+OrtoolsEnv::OrtoolsEnv(ReducedInstance instance) :
+        BaseEnv(std::move(instance)),
     demands{computeDemands(agents.size(), tasks.size())},
     manager{
         buildRoutingIndexManager(static_cast<int>(agents.size()), static_cast<int>(distanceMatrix.size()))
@@ -40,15 +80,9 @@ OrtoolsEnv::RoutingIndexManager OrtoolsEnv::buildRoutingIndexManager(int nAgents
     };
 }
 
-int OrtoolsEnv::buildDistanceCallback(RoutingModel &routingModel, const RoutingIndexManager &manager,
-                                      const CompressedDistanceMatrix &distanceMatrix) {
-    int callbackIndex = routingModel.RegisterTransitCallback(
-        [&manager, &distanceMatrix](int64_t fromIndex, int64_t toIndex) -> int64_t {
-            auto fromNode = manager.IndexToNode(fromIndex).value();
-            auto toNode = manager.IndexToNode(toIndex).value();
-            return distanceMatrix[fromNode][toNode];
-        }
-    );
+int OrtoolsEnv::buildDistanceCallback(RoutingModel &routingModel, const CompressedDistanceMatrix &distanceMatrix) {
+    // the model keeps its own copy, indexed by node: no IndexToNode and no std::function call per transit
+    int callbackIndex = routingModel.RegisterTransitMatrix(distanceMatrix);
 
     routingModel.SetArcCostEvaluatorOfAllVehicles(callbackIndex);
     return callbackIndex;
@@ -66,19 +100,134 @@ std::vector<int64_t> OrtoolsEnv::computeDemands(size_t nAgents, size_t nTasks) {
     return demands;
 }
 
-TASolution OrtoolsEnv::solve(int capacity, int makespan) const {
-    RoutingModel routingModel{manager};
-    auto transitCallbackIndex{buildDistanceCallback(routingModel, manager, distanceMatrix)};
-    auto demandCallbackIndex{buildDemandCallback(routingModel, manager, demands)};
+void OrtoolsEnv::buildModel(RoutingModel &routingModel, const RoutingIndexManager &indexManager, int capacity,
+                            int makespan, const OrtoolsSettings &search) const {
+    auto transitCallbackIndex{buildDistanceCallback(routingModel, distanceMatrix)};
+    auto demandCallbackIndex{buildDemandCallback(routingModel, demands)};
 
     addDistanceDimension(makespan, routingModel, transitCallbackIndex);
     addCapacityDimension(capacity, routingModel, demandCallbackIndex, agents.size());
-    configurePickupAndDeliveries(routingModel);
+    configurePickupAndDeliveries(routingModel, indexManager, search.pickupDeliveryPolicy);
+}
+
+const operations_research::Assignment* OrtoolsEnv::solveModel(RoutingModel &routingModel, const OrtoolsSettings &search,
+                                                              double timeLimit, AssignmentStats *stats) const {
+    ScopedTimer timer{probeTimer};
+    auto start = std::chrono::steady_clock::now();
+    if (stats != nullptr && stats->firstSolutionTime < 0){
+        // stats->time is the time already spent on previous solves
+        const double elapsedBefore = stats->time;
+        routingModel.AddAtSolutionCallback([stats, start, elapsedBefore](){
+            if (stats->firstSolutionTime < 0){
+                stats->firstSolutionTime = elapsedBefore +
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        });
+    }
+
+    const auto* solutionPtr = routingModel.SolveWithParameters(search.toSearchParameters(timeLimit));
+
+    if (stats != nullptr){
+        stats->time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++stats->nSolves;
+        if (solutionPtr != nullptr){
+            stats->span = getSpan(solutionPtr, routingModel);
+        }
+    }
+
+    return solutionPtr;
+}
+
+TASolution OrtoolsEnv::solve(int capacity, int makespan, const OrtoolsSettings &search, double timeLimit,
+                             AssignmentStats *stats, ThreadBudget *budget) const {
+    if (search.workers > 1){
+        return solvePortfolio(capacity, makespan, search, timeLimit, stats, budget);
+    }
+
+    RoutingModel routingModel{manager};
+    buildModel(routingModel, manager, capacity, makespan, search);
+
+    const auto* solutionPtr = solveModel(routingModel, search, timeLimit, stats);
+    if (stats != nullptr && solutionPtr != nullptr){
+        stats->makespanBound = makespan;
+    }
+
+    return getSolution(solutionPtr, routingModel, manager);
+}
+
+TASolution OrtoolsEnv::solvePortfolio(int capacity, int makespan, const OrtoolsSettings &search, double timeLimit,
+                                      AssignmentStats *stats, ThreadBudget *budget) const {
+    struct WorkerResult{
+        TASolution solution;
+        int64_t objective = -1;
+        AssignmentStats stats;
+    };
+
+    // the calling thread already holds a token of the budget
+    unsigned nWorkers = search.workers;
+    if (budget != nullptr){
+        nWorkers = 1 + budget->tryAcquire(search.workers - 1);
+    }
 
-    auto searchParameters{addSearchParameters()};
+    std::vector<WorkerResult> results(nWorkers);
+    auto work = [&](unsigned worker){
+        // every worker has its own index manager and model, nothing of the solver is shared between threads
+        const auto settings = search.withWorkerConfig(worker);
+        const RoutingIndexManager indexManager{
+            buildRoutingIndexManager(static_cast<int>(agents.size()), static_cast<int>(distanceMatrix.size()))
+        };
+        RoutingModel routingModel{indexManager};
+        buildModel(routingModel, indexManager, capacity, makespan, settings);
+
+        auto& result = results[worker];
+        const auto* solutionPtr = solveModel(routingModel, settings, timeLimit, &result.stats);
+        if (solutionPtr != nullptr){
+            result.objective = solutionPtr->ObjectiveValue();
+            result.solution = getSolution(solutionPtr, routingModel, indexManager);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(nWorkers - 1);
+    for (unsigned worker = 1 ; worker < nWorkers ; ++worker){
+        threads.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto& thread : threads){
+        thread.join();
+    }
+    if (budget != nullptr){
+        budget->release(nWorkers - 1);
+    }
+
+    // smallest makespan first, then the smallest objective
+    const WorkerResult* best = nullptr;
+    double firstSolutionTime = -1;
+    for (const auto& result : results){
+        if (result.stats.firstSolutionTime >= 0 &&
+            (firstSolutionTime < 0 || result.stats.firstSolutionTime < firstSolutionTime)){
+            firstSolutionTime = result.stats.firstSolutionTime;
+        }
+        if (!result.solution.empty() && (best == nullptr ||
+            std::make_pair(result.stats.span, result.objective) < std::make_pair(best->stats.span, best->objective))){
+            best = &result;
+        }
+    }
+
+    if (stats != nullptr){
+        if (stats->firstSolutionTime < 0 && firstSolutionTime >= 0){
+            stats->firstSolutionTime = stats->time + firstSolutionTime;
+        }
+        stats->time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->nSolves += static_cast<int>(nWorkers);
+        if (best != nullptr){
+            stats->span = best->stats.span;
+            stats->makespanBound = makespan;
+        }
+    }
 
-    const auto* solutionPtr = routingModel.SolveWithParameters(searchParameters);
-    return getSolution(solutionPtr, routingModel);
+    return best != nullptr ? best->solution : TASolution{};
 }
 
 void OrtoolsEnv::addCapacityDimension(int capacity, RoutingModel &routingModel, int demandCallbackIndex, size_t nAgents) {
@@ -103,32 +252,57 @@ void OrtoolsEnv::addDistanceDimension(int makespan, RoutingModel &routingModel,
     );
 
     auto* distanceDimensionPtr = routingModel.GetMutableDimension(distanceDimensionString);
-    distanceDimensionPtr->SetGlobalSpanCostCoefficient(100);
-    assert(distanceDimensionPtr->global_span_cost_coefficient() == 100);
+    distanceDimensionPtr->SetGlobalSpanCostCoefficient(makespanWeight);
+    assert(distanceDimensionPtr->global_span_cost_coefficient() == makespanWeight);
 }
 
-int OrtoolsEnv::buildDemandCallback(RoutingModel &routingModel, const OrtoolsEnv::RoutingIndexManager &manager,
-                                    const std::vector<int64_t> &demands) {
+int OrtoolsEnv::buildDemandCallback(RoutingModel &routingModel, const std::vector<int64_t> &demands) {
+    return routingModel.RegisterUnaryTransitVector(demands);
+}
 
-    return routingModel.RegisterUnaryTransitCallback(
-        [&manager, &demands](int64_t fromIndex) -> int64_t {
-            int fromNode = manager.IndexToNode(fromIndex).value();
-            return demands[fromNode];
-        }
-    );
+int64_t OrtoolsEnv::getSpan(const operations_research::Assignment *pSolution, const RoutingModel &routingModel) {
+    const auto& distanceDimension = routingModel.GetDimensionOrDie(distanceDimensionString);
+    int64_t span = 0;
+    for (int vehicleId = 0 ; vehicleId < routingModel.vehicles() ; ++vehicleId){
+        span = std::max(span, pSolution->Value(distanceDimension.CumulVar(routingModel.End(vehicleId))));
+    }
+    return span;
 }
 
-OrtoolsEnv::RoutingSearchParameters OrtoolsEnv::addSearchParameters() {
-    auto routingSearchParams = operations_research::DefaultRoutingSearchParameters();
+uint64_t OrtoolsEnv::assignmentKey(int capacity, const OrtoolsSettings &search) const {
+    // FNV-1a over 8 byte words
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](int64_t value){
+        for (int byte = 0 ; byte < 8 ; ++byte){
+            hash ^= static_cast<uint64_t>(value >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
 
-    routingSearchParams.set_first_solution_strategy(
-        firstSolutionAlg
-    );
-    routingSearchParams.set_local_search_metaheuristic(
-        localSearchAlg
-    );
-    routingSearchParams.mutable_time_limit()->set_seconds(30);
-    return routingSearchParams;
+    add(static_cast<int64_t>(nRows));
+    add(static_cast<int64_t>(nCols));
+    add(static_cast<int64_t>(agents.size()));
+    for (auto agent : agents){
+        add(agent);
+    }
+    add(static_cast<int64_t>(tasks.size()));
+    for (const auto& [pickup, delivery] : tasks){
+        add(pickup);
+        add(delivery);
+    }
+    add(capacity);
+    add(search.firstSolutionStrategy);
+    add(search.localSearchMetaheuristic);
+    add(static_cast<int64_t>(search.timeLimit * 1e6));
+    add(search.solutionLimit);
+    add(static_cast<int64_t>(search.lnsTimeLimit * 1e6));
+    add(search.pickupDeliveryPolicy);
+    add(search.workers);
+    for (auto c : std::string_view{search.makespanPolicyName()}){
+        add(c);
+    }
+
+    return hash;
 }
 
 Coord2D OrtoolsEnv::get2DCoord(size_t globalIndex) const{
@@ -149,7 +323,8 @@ Coord2D OrtoolsEnv::get2DCoord(size_t globalIndex) const{
     return {compressedCoord / nCols, compressedCoord % nCols};
 }
 
-TASolution OrtoolsEnv::getSolution(const operations_research::Assignment *pSolution, RoutingModel &routingModel) const{
+TASolution OrtoolsEnv::getSolution(const operations_research::Assignment *pSolution, RoutingModel &routingModel,
+                                   const RoutingIndexManager &indexManager) const{
     if(pSolution == nullptr){
         return {};
     }
@@ -163,7 +338,7 @@ TASolution OrtoolsEnv::getSolution(const operations_research::Assignment *pSolut
 
         auto index = routingModel.Start(vehicleId);
         while(!routingModel.IsEnd(index)){
-            auto nodeIndex = manager.IndexToNode(index).value();
+            auto nodeIndex = indexManager.IndexToNode(index).value();
             //values.push_back(get2DCoord(nodeIndex));
             values.push_back(linearizeCoord(get2DCoord(nodeIndex)));
             index = pSolution->Value(routingModel.NextVar(index));
@@ -174,54 +349,80 @@ TASolution OrtoolsEnv::getSolution(const operations_research::Assignment *pSolut
     return solution;
 }
 
-void OrtoolsEnv::configurePickupAndDeliveries(RoutingModel &routingModel) const{
+void OrtoolsEnv::configurePickupAndDeliveries(RoutingModel &routingModel, const RoutingIndexManager &indexManager,
+                                              RoutingModel::PickupAndDeliveryPolicy policy) const{
     using NodeIndex = RoutingIndexManager::NodeIndex;
-    auto* const solver = routingModel.solver();
-    const auto& distanceDimension = routingModel.GetDimensionOrDie(distanceDimensionString);
 
-    for (const auto& taskCoords : tasks){
-        auto pickupIndex = manager.NodeToIndex(NodeIndex {static_cast<int>(coordToIndexMap.at(taskCoords.first))});
-        auto deliveryIndex = manager.NodeToIndex(NodeIndex {static_cast<int>(coordToIndexMap.at(taskCoords.second))});
+    // the pickup and the delivery of task i are the nodes nAgents + 2i and nAgents + 2i + 1, whatever their cells;
+    // AddPickupAndDelivery alone keeps both on the same vehicle with the pickup first
+    const auto nAgents = static_cast<int>(agents.size());
+    for (int i = 0 ; i < static_cast<int>(tasks.size()) ; ++i){
+        auto pickupIndex = indexManager.NodeToIndex(NodeIndex{nAgents + 2 * i});
+        auto deliveryIndex = indexManager.NodeToIndex(NodeIndex{nAgents + 2 * i + 1});
 
         routingModel.AddPickupAndDelivery(pickupIndex, deliveryIndex);
-
-        //same robot
-        solver->AddConstraint(
-            solver->MakeEquality(routingModel.VehicleVar(pickupIndex), routingModel.VehicleVar(deliveryIndex))
-        );
-
-        // each item must be picked up before it is delivered
-        solver->AddConstraint(
-            solver->MakeLessOrEqual(
-                distanceDimension.CumulVar(pickupIndex),
-                distanceDimension.CumulVar(deliveryIndex)
-            )
-        );
     }
-}
 
-CoordToIndexMap OrtoolsEnv::buildCoordToIndexMap(const CompressedCoordVector& agents, const CompressedTasksVector& tasks) {
-    CoordToIndexMap coordToIndexMap;
-    int i = 0;
+    routingModel.SetPickupAndDeliveryPolicyOfAllVehicles(policy);
+}
 
-    for(auto a : agents){
-        coordToIndexMap.insert({a, i++});
-    }
+TASolution OrtoolsEnv::solve(int capacity, const OrtoolsSettings &search) const {
+    return solve(capacity, std::chrono::steady_clock::time_point::max(), search);
+}
 
-    for(const auto& t : tasks){
-        coordToIndexMap.insert({t.first, i++});
-        coordToIndexMap.insert({t.second, i++});
+TASolution OrtoolsEnv::solve(int capacity, std::chrono::steady_clock::time_point deadline, const OrtoolsSettings &search,
+                             AssignmentStats *stats, ThreadBudget *budget) const {
+    ScopedTimer timer{assignmentTimer};
+    if (search.makespanPolicy == MakespanPolicy::INCREASING){
+        return solveIncreasing(capacity, deadline, search, stats, budget);
     }
-
-    return coordToIndexMap;
+    return solveSpanCost(capacity, deadline, search, stats, budget);
 }
 
-TASolution OrtoolsEnv::solve(int capacity) const {
+TASolution OrtoolsEnv::solveIncreasing(int capacity, std::chrono::steady_clock::time_point deadline,
+                                       const OrtoolsSettings &search, AssignmentStats *stats,
+                                       ThreadBudget *budget) const {
     auto maxMakespan = static_cast<int>(tasks.size() * 2 * getMaxDistance());
     TASolution solution{};
 
     for (int makespan = 20; makespan <= maxMakespan && solution.empty(); ++makespan) {
-        solution = solve(capacity, makespan);
+        double timeLimit = solveTimeLimit(deadline, search);
+        if (timeLimit <= 0) {
+            break;
+        }
+        solution = solve(capacity, makespan, search, timeLimit, stats, budget);
+    }
+
+    return solution;
+}
+
+TASolution OrtoolsEnv::solveSpanCost(int capacity, std::chrono::steady_clock::time_point deadline,
+                                     const OrtoolsSettings &search, AssignmentStats *stats, ThreadBudget *budget) const {
+    // every route is at most 2 * nTasks legs long, so no route is cut by this horizon
+    const auto horizon = static_cast<int>(std::max<size_t>(tasks.size() * 2 * getMaxDistance(), 1));
+
+    double timeLimit = solveTimeLimit(deadline, search);
+    if (timeLimit <= 0){
+        return {};
+    }
+
+    AssignmentStats ownStats;
+    auto& spanStats = stats != nullptr ? *stats : ownStats;
+    TASolution solution = solve(capacity, horizon, search, timeLimit, &spanStats, budget);
+
+    // a new model per bound, bounded by the dimension capacity: bounding the route ends of the solved model and
+    // solving it again fails after a few re-solves, even where a new model with the same bound is feasible.
+    // A failed solve leaves spanStats at the returned solution
+    while (search.makespanPolicy == MakespanPolicy::TIGHTENING && !solution.empty() && spanStats.span > 0){
+        timeLimit = solveTimeLimit(deadline, search);
+        if (timeLimit <= 0){
+            break;
+        }
+        auto tighter = solve(capacity, static_cast<int>(spanStats.span - 1), search, timeLimit, &spanStats, budget);
+        if (tighter.empty()){
+            break;
+        }
+        solution = std::move(tighter);
     }
 
     return solution;
@@ -0,0 +1,171 @@
+#include <fstream>
+#include <stdexcept>
+#include "instances_evaluation/OrtoolsSettings.hpp"
+
+namespace {
+    void setDuration(google::protobuf::Duration* duration, double seconds){
+        auto wholeSeconds = static_cast<int64_t>(seconds);
+        duration->set_seconds(wholeSeconds);
+        duration->set_nanos(static_cast<int32_t>((seconds - static_cast<double>(wholeSeconds)) * 1e9));
+    }
+
+    std::string trim(const std::string &text){
+        const auto begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos){
+            return "";
+        }
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+}
+
+void OrtoolsSettings::setOption(const std::string &name, const std::string &value) {
+    // std::stod and std::stoll errors do not say which option is wrong
+    auto number = [&name, &value](auto parse){
+        try{
+            return parse(value);
+        }
+        catch (const std::logic_error&){
+            throw std::invalid_argument(name + ": " + value + " is not a number");
+        }
+    };
+
+    if (name == "first_solution_strategy"){
+        if (!FirstSolutionStrategy::Value_Parse(value, &firstSolutionStrategy)){
+            throw std::invalid_argument("unknown first solution strategy " + value);
+        }
+    }
+    else if (name == "local_search_metaheuristic"){
+        if (!LocalSearchMetaheuristic::Value_Parse(value, &localSearchMetaheuristic)){
+            throw std::invalid_argument("unknown local search metaheuristic " + value);
+        }
+    }
+    else if (name == "ortools_time_limit"){
+        timeLimit = number([](const std::string &v){ return std::stod(v); });
+    }
+    else if (name == "solution_limit"){
+        solutionLimit = number([](const std::string &v){ return std::stoll(v); });
+    }
+    else if (name == "lns_time_limit"){
+        lnsTimeLimit = number([](const std::string &v){ return std::stod(v); });
+    }
+    else if (name == "log_search"){
+        if (value != "true" && value != "false" && value != "1" && value != "0"){
+            throw std::invalid_argument("log_search must be true or false");
+        }
+        logSearch = value == "true" || value == "1";
+    }
+    else if (name == "makespan_policy"){
+        if (value == "increasing"){
+            makespanPolicy = MakespanPolicy::INCREASING;
+        }
+        else if (value == "span_cost"){
+            makespanPolicy = MakespanPolicy::SPAN_COST;
+        }
+        else if (value == "tightening"){
+            makespanPolicy = MakespanPolicy::TIGHTENING;
+        }
+        else{
+            throw std::invalid_argument("unknown makespan policy " + value);
+        }
+    }
+    else if (name == "pickup_delivery_policy"){
+        using operations_research::RoutingModel;
+        if (value == "any"){
+            pickupDeliveryPolicy = RoutingModel::PICKUP_AND_DELIVERY_NO_ORDER;
+        }
+        else if (value == "lifo"){
+            pickupDeliveryPolicy = RoutingModel::PICKUP_AND_DELIVERY_LIFO;
+        }
+        else if (value == "fifo"){
+            pickupDeliveryPolicy = RoutingModel::PICKUP_AND_DELIVERY_FIFO;
+        }
+        else{
+            throw std::invalid_argument("unknown pickup and delivery policy " + value);
+        }
+    }
+    else if (name == "ortools_workers"){
+        const auto n = number([](const std::string &v){ return std::stoi(v); });
+        if (n < 1){
+            throw std::invalid_argument("ortools_workers must be at least 1");
+        }
+        workers = static_cast<unsigned>(n);
+    }
+    else{
+        throw std::invalid_argument("unknown OR-Tools option " + name);
+    }
+}
+
+void OrtoolsSettings::loadFile(const std::filesystem::path &parametersPath) {
+    std::ifstream parameters{parametersPath};
+    if (!parameters.is_open()){
+        throw std::runtime_error("cannot read OR-Tools parameters " + parametersPath.string());
+    }
+
+    std::string line;
+    while (std::getline(parameters, line)){
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()){
+            continue;
+        }
+        const auto separator = line.find('=');
+        if (separator == std::string::npos){
+            throw std::invalid_argument(parametersPath.string() + ": expected name = value, got " + line);
+        }
+        setOption(trim(line.substr(0, separator)), trim(line.substr(separator + 1)));
+    }
+}
+
+operations_research::RoutingSearchParameters OrtoolsSettings::toSearchParameters(double solveTimeLimit) const {
+    auto routingSearchParams = operations_research::DefaultRoutingSearchParameters();
+
+    routingSearchParams.set_first_solution_strategy(firstSolutionStrategy);
+    routingSearchParams.set_local_search_metaheuristic(localSearchMetaheuristic);
+    setDuration(routingSearchParams.mutable_time_limit(), solveTimeLimit);
+    if (solutionLimit > 0){
+        routingSearchParams.set_solution_limit(solutionLimit);
+    }
+    if (lnsTimeLimit > 0){
+        setDuration(routingSearchParams.mutable_lns_time_limit(), lnsTimeLimit);
+    }
+    routingSearchParams.set_log_search(logSearch);
+
+    return routingSearchParams;
+}
+
+std::string OrtoolsSettings::describe() const {
+    return FirstSolutionStrategy::Value_Name(firstSolutionStrategy) + "/" +
+        LocalSearchMetaheuristic::Value_Name(localSearchMetaheuristic);
+}
+
+const char* OrtoolsSettings::makespanPolicyName() const {
+    switch (makespanPolicy){
+        case MakespanPolicy::SPAN_COST:
+            return "span_cost";
+        case MakespanPolicy::TIGHTENING:
+            return "tightening";
+        default:
+            return "increasing";
+    }
+}
+
+OrtoolsSettings OrtoolsSettings::withWorkerConfig(unsigned worker) const {
+    // strategies and metaheuristics that support pickup and delivery constraints
+    static constexpr std::array strategies{
+        FirstSolutionStrategy::PARALLEL_CHEAPEST_INSERTION, FirstSolutionStrategy::LOCAL_CHEAPEST_INSERTION,
+        FirstSolutionStrategy::PATH_CHEAPEST_ARC, FirstSolutionStrategy::GLOBAL_CHEAPEST_ARC
+    };
+    static constexpr std::array metaheuristics{
+        LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH, LocalSearchMetaheuristic::SIMULATED_ANNEALING,
+        LocalSearchMetaheuristic::TABU_SEARCH
+    };
+
+    OrtoolsSettings settings = *this;
+    settings.workers = 1;
+    if (worker > 0){
+        settings.firstSolutionStrategy = strategies[(worker - 1) % strategies.size()];
+        settings.localSearchMetaheuristic = metaheuristics[((worker - 1) / strategies.size()) % metaheuristics.size()];
+        // only the first worker logs
+        settings.logSearch = false;
+    }
+    return settings;
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include "instances_evaluation/AssignmentProtocol.hpp"
+#include "instances_evaluation/RemoteAssigner.hpp"
+#include "Profiler.h"
+
+static Profiler::Timer& remoteRequestTimer = Profiler::instance().getTimer("remote_assignment_request");
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = boost::asio::ip::tcp;
+
+// one keep-alive HTTP/1.1 connection, only used by the sender thread
+class RemoteAssigner::Connection{
+public:
+    Connection(std::string host, std::string port, std::chrono::milliseconds timeout) :
+        host{std::move(host)},
+        port{std::move(port)},
+        timeout{timeout},
+        resolver{ioContext},
+        stream{ioContext}
+        {}
+
+    ~Connection(){
+        beast::error_code ignored;
+        stream.socket().shutdown(tcp::socket::shutdown_both, ignored);
+    }
+
+    std::string post(const std::string &body){
+        // the server may have closed an idle connection: a reused one gets a second chance on a new connection
+        const bool reused = connected;
+        try{
+            return exchange(body);
+        }
+        catch (const beast::system_error&){
+            connected = false;
+            if (!reused){
+                throw;
+            }
+        }
+        return exchange(body);
+    }
+private:
+    const std::string host;
+    const std::string port;
+    const std::chrono::milliseconds timeout;
+    boost::asio::io_context ioContext;
+    tcp::resolver resolver;
+    beast::tcp_stream stream;
+    bool connected = false;
+
+    // the stream expiry only applies to asynchronous operations: runs the one just started until it completes,
+    // or until the expiry closes the stream
+    void await(const beast::error_code &error){
+        ioContext.restart();
+        ioContext.run();
+        if (error == beast::error::timeout){
+            // not a beast::system_error, post() must not retry it
+            connected = false;
+            throw std::runtime_error("assignment service did not answer within " + std::to_string(timeout.count()) + " ms");
+        }
+        if (error){
+            throw beast::system_error{error};
+        }
+    }
+
+    std::string exchange(const std::string &body){
+        beast::error_code error;
+        auto onDone = [&error](beast::error_code e, auto&&){ error = e; };
+
+        stream.expires_after(timeout);
+        if (!connected){
+            stream.async_connect(resolver.resolve(host, port), onDone);
+            await(error);
+            connected = true;
+        }
+
+        http::request<http::string_body> request{http::verb::post, assignment_protocol::target, 11};
+        request.set(http::field::host, host);
+        request.set(http::field::content_type, "application/json");
+        request.keep_alive(true);
+        request.body() = body;
+        request.prepare_payload();
+        http::async_write(stream, request, onDone);
+        await(error);
+
+        beast::flat_buffer buffer;
+        http::response_parser<http::string_body> parser;
+        parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+        http::async_read(stream, buffer, parser, onDone);
+        await(error);
+        stream.expires_never();
+        auto response = parser.release();
+        if (!response.keep_alive()){
+            connected = false;
+            beast::error_code ignored;
+            stream.socket().shutdown(tcp::socket::shutdown_both, ignored);
+            stream.close();
+        }
+
+        if (response.result() != http::status::ok){
+            std::string message = "assignment service answered " + std::to_string(response.result_int());
+            // an error body names the problem
+            try{
+                assignment_protocol::readResponse(response.body());
+            }
+            catch (const std::runtime_error &e){
+                message = e.what();
+            }
+            catch (const std::invalid_argument&){}
+            throw std::runtime_error(message);
+        }
+        return std::move(response.body());
+    }
+};
+
+RemoteAssigner::RemoteAssigner(std::string host, std::string port, size_t batchSize, std::chrono::milliseconds linger,
+                               std::chrono::milliseconds timeout) :
+    batchSize{std::max<size_t>(batchSize, 1)},
+    linger{linger},
+    connection{std::make_unique<Connection>(std::move(host), std::move(port), timeout)},
+    sender{[this](){ sendBatches(); }}
+    {}
+
+RemoteAssigner::~RemoteAssigner() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+    queued.notify_all();
+    sender.join();
+}
+
+TASolution RemoteAssigner::assign(ReducedInstance instance, int capacity) {
+    std::future<TASolution> assignment;
+    {
+        std::lock_guard lock{mutex};
+        auto& request = pending.emplace_back(Pending{std::move(instance), capacity, {}});
+        assignment = request.assignment.get_future();
+    }
+    queued.notify_all();
+    return assignment.get();
+}
+
+void RemoteAssigner::sendBatches() {
+    for (;;){
+        std::vector<Pending> batch;
+        {
+            std::unique_lock lock{mutex};
+            queued.wait(lock, [this](){ return stopping || !pending.empty(); });
+            if (pending.empty()){
+                return;
+            }
+            queued.wait_for(lock, linger, [this](){ return stopping || pending.size() >= batchSize; });
+
+            // a request has a single capacity
+            const int capacity = pending.front().capacity;
+            for (auto it = pending.begin() ; it != pending.end() && batch.size() < batchSize ;){
+                if (it->capacity == capacity){
+                    batch.push_back(std::move(*it));
+                    it = pending.erase(it);
+                }
+                else{
+                    ++it;
+                }
+            }
+        }
+
+        try{
+            assignment_protocol::Request request{batch.front().capacity, {}};
+            request.instances.reserve(batch.size());
+            for (auto& item : batch){
+                request.instances.push_back(std::move(item.instance));
+            }
+
+            std::vector<TASolution> assignments;
+            {
+                ScopedTimer timer{remoteRequestTimer};
+                assignments = assignment_protocol::readResponse(connection->post(assignment_protocol::writeRequest(request)));
+            }
+            if (assignments.size() != batch.size()){
+                throw std::runtime_error("assignment service returned " + std::to_string(assignments.size()) +
+                                         " assignments for " + std::to_string(batch.size()) + " instances");
+            }
+            for (size_t i = 0 ; i < batch.size() ; ++i){
+                batch[i].assignment.set_value(std::move(assignments[i]));
+            }
+        }
+        catch (...){
+            for (auto& item : batch){
+                item.assignment.set_exception(std::current_exception());
+            }
+        }
+    }
+}
+
+RemoteEnv::RemoteEnv(const std::filesystem::path &mapFilePath, const std::filesystem::path &taskFilePath,
+                     const DistanceTable &fullDistanceMatrix) :
+    BaseEnv(mapFilePath, taskFilePath, fullDistanceMatrix)
+    {}
+
+RemoteEnv::RemoteEnv(const InstanceFileView &instance, const DistanceTable &fullDistanceMatrix) :
+    BaseEnv(instance, fullDistanceMatrix)
+    {}
+
+TASolution RemoteEnv::solve(int capacity, RemoteAssigner &assigner) const {
+    return assigner.assign(getReducedInstance(), capacity);
+}
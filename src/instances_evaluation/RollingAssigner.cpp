@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include "instances_evaluation/RollingAssigner.hpp"
+#include "Profiler.h"
+
+static Profiler::Timer& updateTimer = Profiler::instance().getTimer("rolling_update");
+
+RollingAssigner::RollingAssigner(const DistanceTable &distances, const CompressedCoordVector &agents, int capacity,
+                                 RollingSettings settings) :
+    distances{distances},
+    capacity{capacity},
+    settings{std::move(settings)},
+    published(agents.size())
+    {
+        if (capacity < 1){
+            throw std::invalid_argument("capacity must be at least 1");
+        }
+        routes.reserve(agents.size());
+        for (auto cell : agents){
+            if (!distances.contains(cell)){
+                throw std::invalid_argument("agent cell " + std::to_string(cell) + " is not in the distance table");
+            }
+            routes.push_back(Route{cell, 0, {}, 0});
+        }
+    }
+
+std::vector<size_t> RollingAssigner::addTasks(const CompressedTasksVector &newTasks) {
+    for (const auto& [pickup, delivery] : newTasks){
+        if (!distances.contains(pickup) || !distances.contains(delivery)){
+            throw std::invalid_argument("task " + std::to_string(pickup) + " -> " + std::to_string(delivery) +
+                                        " is not in the distance table");
+        }
+    }
+
+    std::vector<size_t> ids;
+    ids.reserve(newTasks.size());
+    for (const auto& [pickup, delivery] : newTasks){
+        tasks.emplace(nextTaskId, Task{pickup, delivery});
+        arrived.push_back(nextTaskId);
+        ids.push_back(nextTaskId++);
+    }
+    return ids;
+}
+
+void RollingAssigner::advance(int agent, size_t nStops) {
+    if (agent < 0 || agent >= static_cast<int>(routes.size()) || nStops > routes[agent].stops.size()){
+        throw std::invalid_argument("agent " + std::to_string(agent) + " has no " + std::to_string(nStops) + " stops");
+    }
+    if (nStops == 0){
+        return;
+    }
+
+    auto& route = routes[agent];
+    route.cell = stopCell(route.stops[nStops - 1]);
+    for (size_t i = 0 ; i < nStops ; ++i){
+        const auto& stop = route.stops[i];
+        if (stop.pickup){
+            tasks.at(stop.task).onBoard = true;
+            ++route.onBoard;
+        }
+        else{
+            tasks.erase(stop.task);
+            --route.onBoard;
+        }
+    }
+    route.stops.erase(route.stops.begin(), route.stops.begin() + static_cast<std::ptrdiff_t>(nStops));
+    route.length = routeLength(route);
+
+    // the caller already knows the stops it has reached
+    auto& seen = published[agent];
+    seen.erase(seen.begin(), seen.begin() + static_cast<std::ptrdiff_t>(std::min(nStops, seen.size())));
+}
+
+std::vector<RouteDelta> RollingAssigner::update() {
+    ScopedTimer timer{updateTimer};
+
+    auto plan = routes;
+    insertTasks(plan, arrived);
+
+    const auto window = selectWindow(plan);
+    if (!window.empty()){
+        // the window is inserted again from scratch, kept only if that beats the incremental insertion
+        auto candidate = plan;
+        const std::unordered_set<size_t> inWindow(window.begin(), window.end());
+        for (auto& route : candidate){
+            route.stops.erase(std::remove_if(route.stops.begin(), route.stops.end(), [&inWindow](const Stop &stop){
+                return inWindow.count(stop.task) > 0;
+            }), route.stops.end());
+            route.length = routeLength(route);
+        }
+        insertTasks(candidate, window);
+        if (insertion::objective(candidate) < insertion::objective(plan)){
+            plan = std::move(candidate);
+        }
+
+        relocate(plan, window);
+        if (settings.useOrtools){
+            solveWindowOrtools(plan, window);
+        }
+    }
+    arrived.clear();
+    routes = std::move(plan);
+
+    std::vector<RouteDelta> deltas;
+    for (int agent = 0 ; agent < static_cast<int>(routes.size()) ; ++agent){
+        const auto& route = routes[agent];
+        if (route.stops == published[agent]){
+            continue;
+        }
+        published[agent] = route.stops;
+
+        RouteDelta delta{agent, {static_cast<int>(route.cell)}, {}};
+        for (const auto& stop : route.stops){
+            delta.route.push_back(static_cast<int>(stopCell(stop)));
+            delta.stopTasks.push_back(stop.task);
+        }
+        deltas.push_back(std::move(delta));
+    }
+    return deltas;
+}
+
+TASolution RollingAssigner::getSolution() const {
+    TASolution solution;
+    solution.reserve(routes.size());
+    for (const auto& route : routes){
+        std::vector<int> cells{static_cast<int>(route.cell)};
+        for (const auto& stop : route.stops){
+            cells.push_back(static_cast<int>(stopCell(stop)));
+        }
+        solution.push_back(std::move(cells));
+    }
+    return solution;
+}
+
+int64_t RollingAssigner::getMakespan() const {
+    return insertion::objective(routes).first;
+}
+
+size_t RollingAssigner::getNOpenTasks() const {
+    return tasks.size();
+}
+
+int64_t RollingAssigner::stopCell(const Stop &stop) const {
+    const auto& task = tasks.at(stop.task);
+    return stop.pickup ? task.pickup : task.delivery;
+}
+
+int64_t RollingAssigner::routeLength(const Route &route) const {
+    int64_t length = 0;
+    int64_t previous = route.cell;
+    for (const auto& stop : route.stops){
+        const auto cell = stopCell(stop);
+        length += distances(previous, cell);
+        previous = cell;
+    }
+    return length;
+}
+
+insertion::Insertion RollingAssigner::bestInsertion(const Route &route, size_t task) const {
+    const int nPositions = static_cast<int>(route.stops.size());
+
+    insertion::Positions positions{std::vector<int64_t>(nPositions + 1), std::vector<int>(nPositions + 1)};
+    positions.cells[0] = route.cell;
+    positions.load[0] = route.onBoard;
+    for (int position = 1 ; position <= nPositions ; ++position){
+        const auto& stop = route.stops[position - 1];
+        positions.cells[position] = stopCell(stop);
+        positions.load[position] = positions.load[position - 1] + (stop.pickup ? 1 : -1);
+    }
+
+    const auto& cells = tasks.at(task);
+    return insertion::bestInsertion(positions, cells.pickup, cells.delivery, capacity, settings.lockedStops,
+                                    [this](int64_t from, int64_t to){ return distances(from, to); });
+}
+
+void RollingAssigner::insert(Route &route, size_t task, const insertion::Insertion &insertion) const {
+    insertion::insert(route.stops, insertion, Stop{task, true}, Stop{task, false});
+    route.length += insertion.delta;
+}
+
+void RollingAssigner::remove(Route &route, size_t task) const {
+    route.stops.erase(std::remove_if(route.stops.begin(), route.stops.end(), [task](const Stop &stop){
+        return stop.task == task;
+    }), route.stops.end());
+    route.length = routeLength(route);
+}
+
+void RollingAssigner::insertTasks(std::vector<Route> &plan, const std::vector<size_t> &newTasks) const {
+    const auto left = insertion::regretInsertion(plan, newTasks,
+        [this](const Route &route, int, size_t task){ return bestInsertion(route, task); },
+        [this](Route &route, int, size_t task, const insertion::Insertion &insertion){ insert(route, task, insertion); });
+    if (!left.empty()){
+        // the end of a route always has room: only without agents
+        throw std::runtime_error("no agent can take task " + std::to_string(left.front()));
+    }
+}
+
+void RollingAssigner::relocate(std::vector<Route> &plan, const std::vector<size_t> &window) const {
+    const std::unordered_set<size_t> inWindow(window.begin(), window.end());
+    insertion::relocate(plan, settings.maxLocalSearchMoves,
+        [&inWindow](const Route &route, int){
+            std::vector<size_t> movable;
+            for (const auto& stop : route.stops){
+                if (stop.pickup && inWindow.count(stop.task)){
+                    movable.push_back(stop.task);
+                }
+            }
+            return movable;
+        },
+        [this](const Route &route, int, size_t task){ return bestInsertion(route, task); },
+        [this](Route &route, int, size_t task, const insertion::Insertion &insertion){ insert(route, task, insertion); },
+        [this](Route &route, int, size_t task){ remove(route, task); });
+}
+
+std::vector<size_t> RollingAssigner::selectWindow(const std::vector<Route> &plan) const {
+    std::vector<size_t> window = arrived;
+    const std::unordered_set<size_t> isNew(arrived.begin(), arrived.end());
+
+    size_t longest = 0;
+    for (const auto& route : plan){
+        longest = std::max(longest, route.stops.size());
+    }
+
+    // waiting tasks by the position of their pickup, the locked stops excluded
+    size_t nOld = 0;
+    for (size_t position = std::max(settings.lockedStops, 0) ; position < longest && nOld < settings.windowTasks ;
+         ++position){
+        for (const auto& route : plan){
+            if (position >= route.stops.size()){
+                continue;
+            }
+            const auto& stop = route.stops[position];
+            if (stop.pickup && !isNew.count(stop.task)){
+                window.push_back(stop.task);
+                if (++nOld == settings.windowTasks){
+                    break;
+                }
+            }
+        }
+    }
+    return window;
+}
+
+bool RollingAssigner::solveWindowOrtools(std::vector<Route> &plan, const std::vector<size_t> &window) const {
+    using operations_research::RoutingIndexManager;
+    using operations_research::RoutingModel;
+    using NodeIndex = RoutingIndexManager::NodeIndex;
+
+    const int nAgents = static_cast<int>(plan.size());
+    const std::unordered_set<size_t> inWindow(window.begin(), window.end());
+
+    // nodes: the agent cells, every stop of the plan, then the shared dummy end
+    std::vector<int64_t> cells;
+    std::vector<Stop> nodeStops;
+    std::vector<int64_t> demands(nAgents, 0);
+    std::vector<int> nodeAgent;
+    for (int agent = 0 ; agent < nAgents ; ++agent){
+        cells.push_back(plan[agent].cell);
+        nodeAgent.push_back(agent);
+    }
+    std::unordered_map<size_t, int> pickupNodes;
+    std::vector<std::pair<int, int>> pairs;
+    for (int agent = 0 ; agent < nAgents ; ++agent){
+        for (const auto& stop : plan[agent].stops){
+            const int node = static_cast<int>(cells.size());
+            cells.push_back(stopCell(stop));
+            nodeStops.push_back(stop);
+            demands.push_back(stop.pickup ? 1 : -1);
+            nodeAgent.push_back(agent);
+            if (stop.pickup){
+                pickupNodes[stop.task] = node;
+            }
+            else if (auto pickup = pickupNodes.find(stop.task) ; pickup != pickupNodes.end()){
+                pairs.emplace_back(pickup->second, node);
+            }
+        }
+    }
+    const int nNodes = static_cast<int>(cells.size()) + 1;
+    demands.push_back(0);
+
+    CompressedDistanceMatrix matrix(nNodes, std::vector<int64_t>(nNodes, 0));
+    for (int from = 0 ; from < nNodes - 1 ; ++from){
+        for (int to = 0 ; to < nNodes - 1 ; ++to){
+            matrix[from][to] = distances(cells[from], cells[to]);
+        }
+    }
+
+    std::vector<NodeIndex> starts, ends(nAgents, NodeIndex{nNodes - 1});
+    for (int agent = 0 ; agent < nAgents ; ++agent){
+        starts.emplace_back(agent);
+    }
+    const RoutingIndexManager manager{nNodes, nAgents, starts, ends};
+    RoutingModel routingModel{manager};
+
+    const int transit = routingModel.RegisterTransitMatrix(std::move(matrix));
+    routingModel.SetArcCostEvaluatorOfAllVehicles(transit);
+    // no route of a better plan is longer than all of the current ones
+    routingModel.AddDimension(transit, 0, insertion::objective(plan).second + 1, true, "Distance");
+    routingModel.GetMutableDimension("Distance")->SetGlobalSpanCostCoefficient(makespanWeight);
+
+    const int demand = routingModel.RegisterUnaryTransitVector(demands);
+    routingModel.AddDimensionWithVehicleCapacity(demand, 0, std::vector<int64_t>(nAgents, capacity), false, "Capacity");
+    auto* capacityDimension = routingModel.GetMutableDimension("Capacity");
+    for (int agent = 0 ; agent < nAgents ; ++agent){
+        capacityDimension->CumulVar(routingModel.Start(agent))->SetValue(plan[agent].onBoard);
+    }
+
+    for (const auto& [pickup, delivery] : pairs){
+        routingModel.AddPickupAndDelivery(manager.NodeToIndex(NodeIndex{pickup}), manager.NodeToIndex(NodeIndex{delivery}));
+    }
+    routingModel.SetPickupAndDeliveryPolicyOfAllVehicles(settings.search.pickupDeliveryPolicy);
+
+    // the tasks out of the window and the ones on board stay on their agent
+    std::vector<std::vector<int64_t>> currentRoutes(nAgents), locks(nAgents);
+    for (int node = nAgents ; node < nNodes - 1 ; ++node){
+        const auto& stop = nodeStops[node - nAgents];
+        const int agent = nodeAgent[node];
+        const int64_t index = manager.NodeToIndex(NodeIndex{node});
+        if (!inWindow.count(stop.task) || tasks.at(stop.task).onBoard){
+            routingModel.SetAllowedVehiclesForIndex({agent}, index);
+        }
+        if (static_cast<int>(currentRoutes[agent].size()) < settings.lockedStops){
+            locks[agent].push_back(index);
+        }
+        currentRoutes[agent].push_back(index);
+    }
+
+    const auto parameters = settings.search.toSearchParameters(settings.timeLimit);
+    routingModel.CloseModelWithParameters(parameters);
+    if (!routingModel.ApplyLocksToAllVehicles(locks, false)){
+        return false;
+    }
+    const auto* initial = routingModel.ReadAssignmentFromRoutes(currentRoutes, true);
+    if (initial == nullptr){
+        return false;
+    }
+    const auto* solution = routingModel.SolveFromAssignmentWithParameters(initial, parameters);
+    if (solution == nullptr){
+        return false;
+    }
+
+    auto candidate = plan;
+    for (int agent = 0 ; agent < nAgents ; ++agent){
+        auto& route = candidate[agent];
+        route.stops.clear();
+        for (int64_t index = solution->Value(routingModel.NextVar(routingModel.Start(agent))) ;
+             !routingModel.IsEnd(index) ; index = solution->Value(routingModel.NextVar(index))){
+            route.stops.push_back(nodeStops[manager.IndexToNode(index).value() - nAgents]);
+        }
+        route.length = routeLength(route);
+    }
+    if (insertion::objective(candidate) < insertion::objective(plan)){
+        plan = std::move(candidate);
+        return true;
+    }
+    return false;
+}
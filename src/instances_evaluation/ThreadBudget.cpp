@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <thread>
+#include "instances_evaluation/ThreadBudget.hpp"
+
+ThreadBudget::ThreadBudget(unsigned nThreads) :
+    total{nThreads > 0 ? nThreads : std::max(1U, std::thread::hardware_concurrency())},
+    available{total}
+    {}
+
+unsigned ThreadBudget::acquire(unsigned wanted) {
+    std::unique_lock lock{mutex};
+    released.wait(lock, [this](){ return available > 0; });
+    auto granted = std::min(wanted, available);
+    available -= granted;
+    return granted;
+}
+
+unsigned ThreadBudget::tryAcquire(unsigned wanted) {
+    std::lock_guard lock{mutex};
+    auto granted = std::min(wanted, available);
+    available -= granted;
+    return granted;
+}
+
+void ThreadBudget::release(unsigned n) {
+    if (n == 0){
+        return;
+    }
+    {
+        std::lock_guard lock{mutex};
+        available += n;
+    }
+    released.notify_all();
+}
+
+unsigned ThreadBudget::size() const {
+    return total;
+}
@@ -2,14 +2,16 @@
 #include <iostream>
 
 void BaseEnvGenerator::printGrid() const{
-    for (const auto& row : matrix){
-        for (char cell : row){
-            std::cout << cell;
-        }
-        std::cout << '\n';
+    writeGrid(std::cout);
+}
+
+void BaseEnvGenerator::writeGrid(std::ostream &os) const{
+    for (size_t row = 0 ; row < matrix.getNRows() ; ++row){
+        os.write(matrix.data() + row * matrix.getNCols(), static_cast<std::streamsize>(matrix.getNCols()));
+        os << '\n';
     }
 }
 
-const Matrix &BaseEnvGenerator::getMatrix() const{
+const GridMatrix &BaseEnvGenerator::getMatrix() const{
     return matrix;
-}
\ No newline at end of file
+}
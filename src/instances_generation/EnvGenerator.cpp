@@ -1,5 +1,7 @@
 #include "instances_generation/EnvGenerator.hpp"
 #include "commonFunctions.hpp"
+#include "InstanceFile.hpp"
+#include "InstanceArchive.hpp"
 #include <fstream>
 #include <random>
 #include <cassert>
@@ -7,14 +9,13 @@
 #include <numeric>
 #include <filesystem>
 #include <cstdio>
+#include <stdexcept>
+#include <thread>
 #include <boost/algorithm/string.hpp>
 
 using std::vector;
 using std::pair;
 
-std::random_device EnvGenerator::rd{};
-std::mt19937 EnvGenerator::g{rd()};
-
 EnvGenerator::EnvGenerator(const std::string& gridPath) : BaseEnvGenerator() {
     std::fstream fs;
     fs.open(gridPath.c_str(), std::ios::in);
@@ -44,6 +45,9 @@ void EnvGenerator::initializeMatrix(std::fstream &data){
     trim(line);
     nCols = line.size();
 
+    for (char c : line) {
+        nEndpoints += (c == ENDPOINT);
+    }
     ++nRows;
     while(std::getline(data, line)){
         for (char c : line) {
@@ -56,11 +60,11 @@ void EnvGenerator::initializeMatrix(std::fstream &data){
     std::cout << "nRows: " << nRows << " ,nCols: " << nCols << " ,nEndpoints: " << nEndpoints << '\n';
 #endif
 
-    matrix = vector<vector<char>>(nRows, vector<char>(nCols));
+    matrix = GridMatrix(nRows, nCols, FLOOR);
     endpoints.reserve(nEndpoints);
 
 #ifndef NDEBUG
-    std::cout << "matrix rows: " << matrix.size() << " ,matrix cols: " << matrix[0].size() << '\n';
+    std::cout << "matrix rows: " << matrix.getNRows() << " ,matrix cols: " << matrix.getNCols() << '\n';
 #endif
 }
 
@@ -72,7 +76,7 @@ void EnvGenerator::fillMatrix(std::fstream& data) {
     for (int row = 0 ; row < nRows ; ++row){
         std::getline(data, line);
         for (int col = 0 ; col < nCols ; ++col){
-            matrix[row][col] = line[col];
+            matrix(row, col) = line[col];
             if (line[col] == ENDPOINT){
                 endpoints.emplace_back(pair{row, col});
             }
@@ -86,41 +90,129 @@ const CoordVector &EnvGenerator::getEndpoints() const{
     return endpoints;
 }
 
-std::filesystem::path EnvGenerator::generateEnvs(int nInstances, int nAgents, int nTasks, std::string_view instancesPath) {
-    const auto& saveDirPath = createInstancesDir(nAgents, nTasks, instancesPath);
+uint32_t EnvGenerator::uniformBelow(std::mt19937 &rng, uint32_t bound) {
+    // rejection sampling instead of std::uniform_int_distribution, whose output differs between standard libraries
+    const uint32_t threshold = (0U - bound) % bound;
+    uint32_t r;
+    do {
+        r = static_cast<uint32_t>(rng());
+    } while (r < threshold);
+    return r % bound;
+}
+
+GeneratedInstance EnvGenerator::sampleInstance(uint64_t seed, uint32_t instanceId, int nAgents, int nTasks,
+                                               vector<int> &indices) const {
+    std::seed_seq seedSequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), instanceId};
+    std::mt19937 rng{seedSequence};
+
+    // partial Fisher-Yates: only the first nAgents + 2 * nTasks positions are drawn, the swaps are undone
+    // afterwards so that indices is the identity again for the next instance
+    const auto nSampled = static_cast<size_t>(nAgents + 2 * nTasks);
+    vector<pair<size_t, size_t>> swaps;
+    swaps.reserve(nSampled);
+    for (size_t i = 0 ; i < nSampled ; ++i){
+        auto j = i + uniformBelow(rng, static_cast<uint32_t>(indices.size() - i));
+        std::swap(indices[i], indices[j]);
+        swaps.emplace_back(i, j);
+    }
+
+    GeneratedInstance instance;
+    instance.agents.reserve(nAgents);
+    for (int a = 0 ; a < nAgents ; ++a){
+        instance.agents.push_back(endpoints[indices[a]]);
+    }
+
+    instance.tasks.reserve(nTasks);
+    for (int t = nAgents ; t < nTasks * 2 + nAgents ; t+=2){
+        const auto& taskBeginCoord = endpoints[indices[t]];
+        const auto& taskEndCoord = endpoints[indices[t+1]];
+        instance.tasks.push_back(std::pair{taskBeginCoord, taskEndCoord});
+    }
+
+    for (auto it = swaps.crbegin() ; it != swaps.crend() ; ++it){
+        std::swap(indices[it->first], indices[it->second]);
+    }
+
+    return instance;
+}
+
+std::filesystem::path EnvGenerator::generateEnvs(int nInstances, int nAgents, int nTasks, std::string_view instancesPath,
+                                                 InstanceFormat format, uint64_t seed, unsigned nThreads) {
+    if (nAgents < 0 || nTasks < 0 || static_cast<size_t>(nAgents + 2 * nTasks) > endpoints.size()){
+        throw std::invalid_argument(
+            "cannot place " + std::to_string(nAgents) + " agents and " + std::to_string(nTasks) + " tasks on " +
+            std::to_string(endpoints.size()) + " endpoints"
+        );
+    }
 
-    for (int i = 0 ; i < nInstances ; ++i){
-        vector<int> indices(endpoints.size());
-        std::iota(indices.begin(), indices.end(), 0);
+    if (nThreads == 0){
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    nThreads = std::min(nThreads, static_cast<unsigned>(std::max(nInstances, 1)));
 
-        std::shuffle(indices.begin(), indices.end(), g);
+    std::unique_ptr<InstanceArchiveWriter> archive;
+    std::filesystem::path saveDirPath;
+    uint32_t firstId = 0;
 
-//        for (int a = 0 ; a < nAgents ; ++a){
-//            const auto& agentCoord = endpoints[indices[a]];
-//            matrix[agentCoord.first][agentCoord.second] = ROBOT;
-//        }
+    if (format == InstanceFormat::ARCHIVE){
+        std::filesystem::create_directories(instancesPath);
+        saveDirPath = getArchivePath(nAgents, nTasks, instancesPath);
+        archive = std::make_unique<InstanceArchiveWriter>(saveDirPath);
+        firstId = archive->nextId();
+    }
+    else{
+        saveDirPath = createInstancesDir(nAgents, nTasks, instancesPath);
+    }
 
-        agentsCoords.reserve(nAgents);
+    // every thread takes the instances begin + k * nThreads of a block; files are written by the thread that
+    // sampled the instance, archive records are appended in id order once the block is complete
+    const int blockSize = archive ? static_cast<int>(nThreads) * 1024 : nInstances;
+    vector<GeneratedInstance> block(archive ? blockSize : 0);
+
+    for (int blockBegin = 0 ; blockBegin < nInstances ; blockBegin += blockSize){
+        const int blockEnd = std::min(nInstances, blockBegin + blockSize);
+
+        auto generate = [&](unsigned threadIndex){
+            vector<int> indices(endpoints.size());
+            std::iota(indices.begin(), indices.end(), 0);
+
+            for (int i = blockBegin + static_cast<int>(threadIndex) ; i < blockEnd ; i += static_cast<int>(nThreads)){
+                const auto id = firstId + static_cast<uint32_t>(i);
+                auto instance = sampleInstance(seed, id, nAgents, nTasks, indices);
+
+                if (archive){
+                    block[i - blockBegin] = std::move(instance);
+                }
+                else if (format == InstanceFormat::BINARY){
+                    saveInstance(i, saveDirPath, instance);
+                }
+                else{
+                    saveAgents(i, saveDirPath, instance);
+                    saveTasksInfo(i, saveDirPath, instance);
+                }
+            }
+        };
 
-        for (int a = 0 ; a < nAgents ; ++a){
-            agentsCoords.push_back(endpoints[indices[a]]);
+        vector<std::thread> workers;
+        workers.reserve(nThreads - 1);
+        for (unsigned t = 1 ; t < nThreads ; ++t){
+            workers.emplace_back(generate, t);
+        }
+        generate(0);
+        for (auto& worker : workers){
+            worker.join();
         }
-        saveAgents(i, saveDirPath);
-        agentsCoords.clear();
-
-//        for (int a = 0 ; a < nAgents ; ++a){
-//            const auto& agentCoord = endpoints[indices[a]];
-//            matrix[agentCoord.first][agentCoord.second] = ENDPOINT;
-//        }
-
-        tasks.reserve(nTasks);
-        for (int t = nAgents ; t < nTasks * 2 + nAgents ; t+=2){
-            const auto& taskBeginCoord = endpoints[indices[t]];
-            const auto& taskEndCoord = endpoints[indices[t+1]];
-            tasks.push_back(std::pair{taskBeginCoord, taskEndCoord});
+
+        if (archive){
+            for (int i = blockBegin ; i < blockEnd ; ++i){
+                const auto& instance = block[i - blockBegin];
+                archive->add(firstId + static_cast<uint32_t>(i), nRows, nCols, instance.agents, instance.tasks);
+            }
         }
-        saveTasksInfo(i, saveDirPath);
-        tasks.clear();
+    }
+
+    if (archive){
+        archive->close();
     }
 
     return saveDirPath;
@@ -156,45 +248,37 @@ void EnvGenerator::saveMatrix(int instanceIndex, std::string_view path, int nAge
     fclose(stream);
 }
 
-void EnvGenerator::saveTasksInfo(int instanceIndex, const std::filesystem::path &path) const {
-    FILE* stream;
+void EnvGenerator::saveTasksInfo(int instanceIndex, const std::filesystem::path &path, const GeneratedInstance &instance) {
     const auto filename{path / (std::to_string(instanceIndex) + ".tasks")};
 
-#ifdef WIN32
-    freopen_s(&stream, filename.generic_string().data(), "w", stdout);
-#else
-    stream = freopen64(filename.generic_string().data(), "w", stdout);
-#endif
-
-    std::cout << tasks.size() << '\n';
-    for(const auto& task : tasks){
+    std::string content = std::to_string(instance.tasks.size()) + '\n';
+    for(const auto& task : instance.tasks){
         const auto& taskBegin = task.first;
         const auto& taskEnd = task.second;
 
-        std::cout << taskBegin.first << ',' << taskBegin.second << ','
-            << taskEnd.first << ',' << taskEnd.second << '\n';
-
-//        std::cout << "0\t" << taskBegin.first * nCols + taskBegin.second << '\t'
-//            << taskEnd.first * nCols + taskEnd.second << "\t0\t0" << '\n';
+        content += std::to_string(taskBegin.first) + ',' + std::to_string(taskBegin.second) + ','
+            + std::to_string(taskEnd.first) + ',' + std::to_string(taskEnd.second) + '\n';
     }
-    fclose(stream);
+
+    std::ofstream file{filename, std::ios::binary | std::ios::trunc};
+    file << content;
 }
 
-void EnvGenerator::saveAgents(int instanceIndex, const std::filesystem::path &path) {
-    FILE* stream;
+void EnvGenerator::saveAgents(int instanceIndex, const std::filesystem::path &path, const GeneratedInstance &instance) const {
     const auto filename{path / (std::to_string(instanceIndex) + ".agents")};
 
-#ifdef WIN32
-    freopen_s(&stream, filename.generic_string().data(), "w", stdout);
-#else
-    stream = freopen64(filename.generic_string().data(), "w", stdout);
-#endif
-
-    std::cout << matrix.size() << ',' << matrix[0].size() << '\n';
-    std::cout << agentsCoords.size() << '\n';
-    for(const auto& agentCoord : agentsCoords) {
-        std::cout << agentCoord.first << ',' << agentCoord.second << '\n';
+    std::string content = std::to_string(nRows) + ',' + std::to_string(nCols) + '\n';
+    content += std::to_string(instance.agents.size()) + '\n';
+    for(const auto& agentCoord : instance.agents) {
+        content += std::to_string(agentCoord.first) + ',' + std::to_string(agentCoord.second) + '\n';
     }
 
-    fclose(stream);
+    std::ofstream file{filename, std::ios::binary | std::ios::trunc};
+    file << content;
+}
+
+void EnvGenerator::saveInstance(int instanceIndex, const std::filesystem::path &path, const GeneratedInstance &instance) const {
+    instance_file::write(
+        path / (std::to_string(instanceIndex) + instance_file::extension), nRows, nCols, instance.agents, instance.tasks
+    );
 }
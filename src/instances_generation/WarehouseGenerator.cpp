@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include "instances_generation/WarehouseGenerator.hpp"
+
+WarehouseGenerator::WarehouseGenerator(const WarehouseLayout &layout) : BaseEnvGenerator() {
+    if (layout.shelfRows < 1 || layout.shelfBlocks < 1 || layout.shelfLength < 1 || layout.aisleWidth < 1 ||
+        layout.parkingColumns < 0 || layout.endpointSpacing < 1){
+        throw std::invalid_argument("invalid warehouse layout");
+    }
+
+    const int aisle = layout.aisleWidth;
+    const int parkingWidth = layout.parkingColumns * (2 + aisle);
+    const int shelvesWidth = layout.shelfBlocks * layout.shelfLength + (layout.shelfBlocks - 1) * aisle;
+
+    nCols = 2 * aisle + 2 * parkingWidth + shelvesWidth;
+    nRows = 2 * aisle + layout.shelfRows * 3 + (layout.shelfRows - 1) * aisle;
+    matrix = GridMatrix(nRows, nCols, FLOOR);
+
+    fillParking(aisle, layout);
+    fillParking(aisle + parkingWidth + shelvesWidth + aisle, layout);
+    for (int row = 0 ; row < layout.shelfRows ; ++row){
+        for (int block = 0 ; block < layout.shelfBlocks ; ++block){
+            fillShelfBlock(aisle + row * (3 + aisle), aisle + parkingWidth + block * (layout.shelfLength + aisle), layout);
+        }
+    }
+
+    for (unsigned row = 0 ; row < nRows ; ++row){
+        for (unsigned col = 0 ; col < nCols ; ++col){
+            if (matrix(row, col) == ENDPOINT){
+                endpoints.emplace_back(row, col);
+            }
+        }
+    }
+}
+
+void WarehouseGenerator::fillParking(int firstCol, const WarehouseLayout &layout) {
+    // two endpoint columns followed by an aisle, spanning every row but the border aisles
+    for (int column = 0 ; column < layout.parkingColumns ; ++column){
+        const int col = firstCol + column * (2 + layout.aisleWidth);
+        for (unsigned row = layout.aisleWidth ; row < nRows - layout.aisleWidth ; ++row){
+            matrix(row, col) = ENDPOINT;
+            matrix(row, col + 1) = ENDPOINT;
+        }
+    }
+}
+
+void WarehouseGenerator::fillShelfBlock(int firstRow, int firstCol, const WarehouseLayout &layout) {
+    for (int k = 0 ; k < layout.shelfLength ; ++k){
+        const char side = (k % layout.endpointSpacing == 0) ? ENDPOINT : FLOOR;
+        matrix(firstRow, firstCol + k) = side;
+        matrix(firstRow + 1, firstCol + k) = OBSTACLE;
+        matrix(firstRow + 2, firstCol + k) = side;
+    }
+}
+
+const CoordVector &WarehouseGenerator::getEndpoints() const {
+    return endpoints;
+}
+
+DistanceTable WarehouseGenerator::computeDistanceTable(unsigned nThreads) const {
+    const size_t nCells = matrix.size();
+    const size_t nEndpoints = endpoints.size();
+
+    std::vector<uint32_t> cells(nEndpoints);
+    for (size_t i = 0 ; i < nEndpoints ; ++i){
+        cells[i] = static_cast<uint32_t>(endpoints[i].first * nCols + endpoints[i].second);
+    }
+
+    std::vector<int32_t> distances(nEndpoints * nEndpoints);
+    std::atomic<size_t> nextSource{0};
+
+    auto worker = [&](){
+        std::vector<int32_t> cellDistances(nCells);
+        std::vector<uint32_t> frontier;
+        frontier.reserve(nCells);
+
+        for (size_t source = nextSource++ ; source < nEndpoints ; source = nextSource++){
+            std::fill(cellDistances.begin(), cellDistances.end(), -1);
+            frontier.clear();
+            frontier.push_back(cells[source]);
+            cellDistances[cells[source]] = 0;
+
+            // the frontier vector doubles as the BFS queue, cells are visited once
+            for (size_t head = 0 ; head < frontier.size() ; ++head){
+                const uint32_t cell = frontier[head];
+                const size_t row = cell / nCols;
+                const size_t col = cell % nCols;
+                const int32_t next = cellDistances[cell] + 1;
+
+                auto visit = [&](uint32_t neighbour){
+                    if (cellDistances[neighbour] < 0 && matrix[neighbour] != OBSTACLE){
+                        cellDistances[neighbour] = next;
+                        frontier.push_back(neighbour);
+                    }
+                };
+                if (row > 0) visit(cell - nCols);
+                if (row + 1 < nRows) visit(cell + nCols);
+                if (col > 0) visit(cell - 1);
+                if (col + 1 < nCols) visit(cell + 1);
+            }
+
+            int32_t* tableRow = distances.data() + source * nEndpoints;
+            for (size_t target = 0 ; target < nEndpoints ; ++target){
+                tableRow[target] = cellDistances[cells[target]];
+            }
+        }
+    };
+
+    if (nThreads == 0){
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nThreads = static_cast<unsigned>(std::min<size_t>(nThreads, std::max<size_t>(nEndpoints, 1)));
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1 ; i < nThreads ; ++i){
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads){
+        thread.join();
+    }
+
+    return {nCells, cells, std::move(distances)};
+}
+
+void WarehouseGenerator::save(const std::filesystem::path &outputDir, unsigned nThreads) const {
+    std::filesystem::create_directories(outputDir);
+
+    std::ofstream gridFile(outputDir / "grid.txt");
+    if (!gridFile){
+        throw std::runtime_error("cannot write " + (outputDir / "grid.txt").string());
+    }
+    writeGrid(gridFile);
+
+    std::ofstream endpointsFile(outputDir / "endpoints.txt");
+    if (!endpointsFile){
+        throw std::runtime_error("cannot write " + (outputDir / "endpoints.txt").string());
+    }
+    endpointsFile << endpoints.size() << '\n';
+    for (const auto& [row, col] : endpoints){
+        endpointsFile << row << ',' << col << '\n';
+    }
+
+    computeDistanceTable(nThreads).saveEndpointTable(outputDir / "distance_table.npz");
+}